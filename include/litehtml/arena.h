@@ -0,0 +1,82 @@
+#ifndef LH_ARENA_H
+#define LH_ARENA_H
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace litehtml
+{
+	// Monotonic memory arena: allocations bump a pointer inside large blocks and are never
+	// released one by one. All blocks are freed at once when the arena is destroyed.
+	class monotonic_arena
+	{
+		std::vector<std::unique_ptr<char[]>>	m_blocks;
+		char*									m_cur	= nullptr;
+		size_t									m_left	= 0;
+		size_t									m_block_size;
+	public:
+		explicit monotonic_arena(size_t block_size = 64 * 1024) : m_block_size(block_size) {}
+		monotonic_arena(const monotonic_arena&) = delete;
+		monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+		void* allocate(size_t size, size_t align)
+		{
+			size_t pad = (align - (reinterpret_cast<uintptr_t>(m_cur) & (align - 1))) & (align - 1);
+			if(!m_cur || pad + size > m_left)
+			{
+				size_t sz = size + align > m_block_size ? size + align : m_block_size;
+				m_blocks.emplace_back(new char[sz]);
+				m_cur	= m_blocks.back().get();
+				m_left	= sz;
+				pad		= (align - (reinterpret_cast<uintptr_t>(m_cur) & (align - 1))) & (align - 1);
+			}
+			char* ret = m_cur + pad;
+			m_cur	+= pad + size;
+			m_left	-= pad + size;
+			return ret;
+		}
+
+		// frees all blocks at once
+		void release()
+		{
+			m_blocks.clear();
+			m_cur	= nullptr;
+			m_left	= 0;
+		}
+	};
+
+	// Allocator for std::allocate_shared. Every control block holds a reference to the arena,
+	// so the memory stays valid while any object allocated from it is alive.
+	template<class T>
+	class arena_allocator
+	{
+		template<class U> friend class arena_allocator;
+
+		std::shared_ptr<monotonic_arena>	m_arena;
+	public:
+		typedef T	value_type;
+
+		explicit arena_allocator(const std::shared_ptr<monotonic_arena>& arena) : m_arena(arena) {}
+		template<class U>
+		arena_allocator(const arena_allocator<U>& val) : m_arena(val.m_arena) {}
+
+		T* allocate(size_t n)
+		{
+			return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* /*p*/, size_t /*n*/)
+		{
+			// memory is released with the arena
+		}
+
+		template<class U>
+		bool operator==(const arena_allocator<U>& val) const { return m_arena == val.m_arena; }
+		template<class U>
+		bool operator!=(const arena_allocator<U>& val) const { return m_arena != val.m_arena; }
+	};
+}
+
+#endif  // LH_ARENA_H
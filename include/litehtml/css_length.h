@@ -2,9 +2,12 @@
 #define LH_CSS_LENGTH_H
 
 #include "types.h"
+#include "tstring_view.h"
 
 namespace litehtml
 {
+	class keyword_table;
+
 	class css_length
 	{
 		union
@@ -27,9 +30,21 @@ namespace litehtml
 		float		val() const;
 		css_units	units() const;
 		int			calc_percent(int width) const;
-		void		fromString(const string& str, const string& predefs = "", int defValue = 0);
-		static css_length from_string(const string& str, const string& predefs = "", int defValue = 0);
+		void		fromString(tstring_view str, const string& predefs = "", int defValue = 0);
+		void		fromString(tstring_view str, const keyword_table& predefs, int defValue = 0);
+		static css_length from_string(tstring_view str, const string& predefs = "", int defValue = 0);
+		static css_length from_string(tstring_view str, const keyword_table& predefs, int defValue = 0);
 		string		to_string() const;
+
+		bool operator==(const css_length& val) const
+		{
+			if(m_is_predefined != val.m_is_predefined) return false;
+			if(m_is_predefined) return m_predef == val.m_predef;
+			return m_value == val.m_value && m_units == val.m_units;
+		}
+		bool operator!=(const css_length& val) const { return !(*this == val); }
+	private:
+		bool		parse_number(tstring_view str, int defValue);
 	};
 
 	using length_vector = std::vector<css_length>;
@@ -12,9 +12,12 @@ namespace litehtml
 {
     class element;
     class document;
+    class style;
 
     class css_properties
     {
+    public:
+        typedef std::shared_ptr<css_properties>	ptr;
     private:
         element_position		m_el_position;
         text_align				m_text_align;
@@ -73,9 +76,11 @@ namespace litehtml
         caption_side			m_caption_side;
 
     private:
-        void compute_font(const element* el, const std::shared_ptr<document>& doc);
-        void compute_background(const element* el, const std::shared_ptr<document>& doc);
-        void compute_flex(const element* el, const std::shared_ptr<document>& doc);
+        void init(const css_properties* parent, const std::shared_ptr<document>& doc);
+        void cascade(const style& st, const css_properties* parent);
+        void compute_font(const css_properties* parent, const std::shared_ptr<document>& doc);
+        void compute_background(const std::shared_ptr<document>& doc);
+        void compute_flex(const css_properties* parent, const std::shared_ptr<document>& doc);
 
     public:
         css_properties() :
@@ -123,6 +128,9 @@ namespace litehtml
                 m_flex_align_content(flex_align_content_stretch)
         {}
 
+        // shared style with the initial values
+        static const ptr& initial();
+
         void compute(const element* el, const std::shared_ptr<document>& doc);
         std::vector<std::tuple<string, string>> dump_get_attrs();
 
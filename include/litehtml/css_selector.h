@@ -1,6 +1,7 @@
 #ifndef LH_CSS_SELECTOR_H
 #define LH_CSS_SELECTOR_H
 
+#include <cstring>
 #include "style_litehtml.h"
 #include "media_query.h"
 
@@ -193,6 +194,7 @@ namespace litehtml
 		style::ptr				m_style;
 		int						m_order;
 		media_query_list::ptr	m_media_query;
+		std::vector<unsigned>	m_ancestor_hashes;	// tag/id/class keys every match requires among the ancestors
 	public:
 		explicit css_selector(const media_query_list::ptr& media = nullptr)
 		{
@@ -217,23 +219,16 @@ namespace litehtml
 			m_specificity	= val.m_specificity;
 			m_order			= val.m_order;
 			m_media_query	= val.m_media_query;
+			m_ancestor_hashes	= val.m_ancestor_hashes;
 		}
 
 		bool parse(const string& text);
 		void calc_specificity();
-		bool is_media_valid() const;
+		void calc_ancestor_hashes();
+		bool is_media_valid(const document* doc) const;
 		void add_media_to_doc(document* doc) const;
 	};
 
-	inline bool css_selector::is_media_valid() const
-	{
-		if(!m_media_query)
-		{
-			return true;
-		}
-		return m_media_query->is_used();
-	}
-
 
 	//////////////////////////////////////////////////////////////////////////
 
@@ -267,6 +262,74 @@ namespace litehtml
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// Counting Bloom filter of the tag/id/class keys of the current element's ancestors.
+	// It is maintained while styles are applied to the tree and rejects selectors
+	// whose ancestor compounds cannot match before walking the parents.
+	class ancestor_filter
+	{
+		static const unsigned key_bits		= 12;
+		static const unsigned table_size	= 1 << key_bits;
+		static const unsigned key_mask		= table_size - 1;
+
+		unsigned char	m_counters[table_size];
+	public:
+		ancestor_filter()
+		{
+			memset(m_counters, 0, sizeof(m_counters));
+		}
+
+		static unsigned tag_hash(string_id tag)		{ return mix((unsigned) tag + 1, 0x9E3779B1u); }
+		static unsigned id_hash(string_id id)		{ return mix((unsigned) id + 1, 0x85EBCA77u); }
+		static unsigned class_hash(string_id cls)	{ return mix((unsigned) cls + 1, 0xC2B2AE3Du); }
+
+		void add(unsigned hash)
+		{
+			increment(hash & key_mask);
+			increment((hash >> key_bits) & key_mask);
+		}
+
+		void remove(unsigned hash)
+		{
+			decrement(hash & key_mask);
+			decrement((hash >> key_bits) & key_mask);
+		}
+
+		bool may_contain(unsigned hash) const
+		{
+			return m_counters[hash & key_mask] && m_counters[(hash >> key_bits) & key_mask];
+		}
+
+		// returns false if the selector can't match any element below the current ancestors
+		bool may_match(const css_selector& selector) const
+		{
+			for(auto hash : selector.m_ancestor_hashes)
+			{
+				if(!may_contain(hash)) return false;
+			}
+			return true;
+		}
+
+	private:
+		static unsigned mix(unsigned key, unsigned salt)
+		{
+			unsigned hash = key * salt;
+			return hash ^ (hash >> 15);
+		}
+
+		// saturated counters are never decremented, so the filter stays conservative
+		void increment(unsigned idx)
+		{
+			if(m_counters[idx] != 0xFF) m_counters[idx]++;
+		}
+
+		void decrement(unsigned idx)
+		{
+			if(m_counters[idx] != 0xFF && m_counters[idx] != 0) m_counters[idx]--;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
 	class used_selector
 	{
 	public:
@@ -0,0 +1,46 @@
+#ifndef LH_CSS_TOKENIZER_H
+#define LH_CSS_TOKENIZER_H
+
+#include "os_types.h"
+
+namespace litehtml
+{
+	// Forward-only scanner over a CSS buffer. It never copies the input: callers get
+	// positions inside the buffer and extract the few strings they actually need.
+	// Comments are skipped everywhere, quoted strings and parentheses are stepped over
+	// as a whole.
+	class css_tokenizer
+	{
+		const char*	m_pos;
+		const char*	m_end;
+	public:
+		css_tokenizer(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+		bool		eof() const		{ return m_pos >= m_end; }
+		char		peek() const	{ return *m_pos; }
+		const char*	pos() const		{ return m_pos; }
+		const char*	end() const		{ return m_end; }
+		void		next()			{ m_pos++; }
+
+		// skips whitespace and comments
+		void skip_whitespace();
+		// moves to the first of the stop characters that is not inside a comment, a string
+		// or parentheses; returns false if the end of the buffer was reached
+		bool skip_until(const char* stops);
+		// the current character is '{': moves to the matching '}'
+		bool skip_block();
+
+		// copies [begin, end) with comments removed and whitespace trimmed
+		static void get_text(const char* begin, const char* end, string& text);
+		// returns the position of the last top-level occurrence of chr in [begin, end), or end
+		static const char* find_last(const char* begin, const char* end, char chr);
+
+	private:
+		bool at_comment() const { return m_pos + 1 < m_end && m_pos[0] == '/' && m_pos[1] == '*'; }
+		void skip_comment();
+		void skip_string();
+		void skip_parens();
+	};
+}
+
+#endif  // LH_CSS_TOKENIZER_H
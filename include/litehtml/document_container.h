@@ -61,10 +61,14 @@ namespace litehtml
         virtual void				get_media_features(litehtml::media_features& media) const = 0;
         virtual void				get_language(litehtml::string& language, litehtml::string& culture) const = 0;
         virtual litehtml::string	resolve_color(const litehtml::string& /*color*/) const { return litehtml::string(); }
-        virtual void				split_text(const char* text, const std::function<void(const char*)>& on_word, const std::function<void(const char*)>& on_space);
+        // Splits UTF-8 text into words and spaces. The callbacks receive slices of text
+        // (pointer and length in bytes); they are not NUL-terminated. A run of spaces and
+        // tabs is reported as one space, other whitespace characters one by one.
+        virtual void				split_text(const char* text, const std::function<void(const char*, size_t)>& on_word, const std::function<void(const char*, size_t)>& on_space);
 
     protected:
-        ~document_container() = default;
+        // drops the stylesheets cached for this container: a new one may get the same address
+        ~document_container();
     };
 }
 
@@ -4,6 +4,8 @@
 #include "style_litehtml.h"
 #include "types.h"
 #include "master_css.h"
+#include "arena.h"
+#include "tstring_view.h"
 
 namespace litehtml
 {
@@ -45,9 +47,44 @@ namespace litehtml
 
     class html_tag;
     class render_item;
+    class style_sharing_candidates;
+    class ancestor_filter;
+
+    // Everything a resolved font depends on
+    struct font_key
+    {
+        string_id	family;
+        int			size;
+        int			weight;			// numeric weight: 100-900
+        font_style	style;
+        unsigned	decoration;		// font_decoration_* flags
+
+        bool operator==(const font_key& val) const
+        {
+            return family == val.family && size == val.size && weight == val.weight &&
+                   style == val.style && decoration == val.decoration;
+        }
+    };
+
+    struct font_key_hash
+    {
+        size_t operator()(const font_key& key) const
+        {
+            size_t h = (size_t) key.family;
+            h = h * 31 + (size_t) key.size;
+            h = h * 31 + (size_t) key.weight;
+            h = h * 31 + (size_t) key.style;
+            return h * 31 + key.decoration;
+        }
+    };
+
+    typedef std::unordered_map<font_key, font_item, font_key_hash> fonts_map;
 
     class document : public std::enable_shared_from_this<document>
     {
+        friend class element;
+        friend class html_tag;
+        friend class el_text;
     public:
         typedef std::shared_ptr<document>	ptr;
         typedef std::weak_ptr<document>		weak_ptr;
@@ -59,24 +96,45 @@ namespace litehtml
         css_text::vector					m_css;
         litehtml::css						m_styles;
         litehtml::web_color					m_def_color;
-        litehtml::css						m_master_css;
-        litehtml::css						m_user_css;
+        css::const_ptr						m_master_css;
+        css::const_ptr						m_user_css;
         litehtml::size						m_size;
         litehtml::size						m_content_size;
         position::vector					m_fixed_boxes;
         media_query_list::vector			m_media_lists;
+        std::unordered_map<const media_query_list*, bool>	m_media_used;	// state of m_media_lists in this document
         element::ptr						m_over_element;
         std::list<std::shared_ptr<render_item>>		m_tabular_elements;
         media_features						m_media;
         string								m_lang;
         string								m_culture;
+        std::shared_ptr<monotonic_arena>	m_arena;
+        style_sharing_candidates*			m_style_siblings = nullptr;	// siblings styled by the running html_tag::compute_styles loop
+        ancestor_filter*					m_ancestor_filter = nullptr;	// ancestors of the running html_tag::apply_stylesheet recursion
+        int									m_layout_generation = 0;	// incremented by every render(), invalidates layout caches
+        int									m_rendered_width = -1;		// max_width of the last layout
+        int									m_layout_bottom = -1;		// blocks below it are not laid out yet, -1 lays out everything
+        int									m_layout_overscan = 0;		// laid out beyond the requested region
+        std::vector<std::shared_ptr<render_item>>	m_pending_layout;	// the first child left without layout of every block
     public:
         document(document_container* objContainer);
         virtual ~document();
 
         document_container*				container()	{ return m_container; }
         uint_ptr						get_font(const char* name, int size, const char* weight, const char* style, const char* decoration, font_metrics* fm);
+        uint_ptr						get_font(const font_key& key, font_metrics* fm);
         int								render(int max_width, render_type rt = render_all);
+        // Lays out the block children only down to the viewport (in document coordinates) and
+        // estimates the heights of the rest. They are laid out when draw() or hit-testing reaches
+        // them, so height() is refined as the document is scrolled.
+        int								render(int max_width, const position& viewport, render_type rt = render_all);
+        // Like render(), but lays out again only the render items that need layout since the last
+        // render, e.g. restyled by on_mouse_over(). Changes unknown to the document, like the
+        // loaded images, need render().
+        int								render_changes(int max_width, render_type rt = render_all);
+        int								layout_generation() const	{ return m_layout_generation; }
+        int								layout_bottom() const		{ return m_layout_bottom; }
+        void							add_pending_layout(const std::shared_ptr<render_item>& ri)	{ m_pending_layout.push_back(ri); }
         void							draw(uint_ptr hdc, int x, int y, const position* clip);
         web_color						get_def_color()	{ return m_def_color; }
         int								to_pixels(const char* str, int fontSize, bool* is_percent = nullptr) const;
@@ -97,6 +155,7 @@ namespace litehtml
         void							get_fixed_boxes(position::vector& fixed_boxes);
         void							add_fixed_box(const position& pos);
         void							add_media_list(const media_query_list::ptr& list);
+        bool							is_media_used(const media_query_list::ptr& list) const;
         bool							media_changed();
         bool							lang_changed();
         bool							match_lang(const string& lang);
@@ -106,18 +165,42 @@ namespace litehtml
         void							append_children_from_string(element& parent, const char* str);
         void							dump(dumper& cout);
 
-        static litehtml::document::ptr	createFromString(const char* str, litehtml::document_container* objPainter, const char* master_styles = litehtml::master_css, const char* user_styles = "");
+        // Creates an element or render item of this document. Nodes of documents created
+        // with use_arena are allocated from the document's arena instead of the heap.
+        template<class T, class... Args>
+        std::shared_ptr<T>				make_node(Args&&... args);
+        // Keeps a NUL-terminated copy of the text in the document's arena. Returns an empty
+        // view if the document has no arena: the caller must own the text itself then.
+        tstring_view					store_text(const char* text, size_t len);
 
-    private:
-        uint_ptr	add_font(const char* name, int size, const char* weight, const char* style, const char* decoration, font_metrics* fm);
+        static int						font_weight_value(font_weight weight);
+        static unsigned					font_decoration_value(const char* decoration);
 
+        static litehtml::document::ptr	createFromString(const char* str, litehtml::document_container* objPainter, const char* master_styles = litehtml::master_css, const char* user_styles = "", bool use_arena = false);
+
+    private:
         void create_node(void* gnode, elements_list& elements, bool parseTextNode);
+        int start_layout(int max_width, render_type rt);
+        int layout(int max_width, render_type rt);
+        // lays out the deferred blocks down to the bottom (in document coordinates), -1 lays out all
+        void layout_to(int bottom);
+        // gets the parsed stylesheet from the cache and adds its media lists to the document
+        css::const_ptr use_stylesheet(const char* str, const char* baseurl = nullptr, const char* media = nullptr);
         bool update_media_lists(const media_features& features);
         void fix_tables_layout();
         void fix_table_children(const std::shared_ptr<render_item>& el_ptr, style_display disp, const char* disp_str);
         void fix_table_parent(const std::shared_ptr<render_item> & el_ptr, style_display disp, const char* disp_str);
     };
 
+    template<class T, class... Args>
+    inline std::shared_ptr<T> document::make_node(Args&&... args)
+    {
+        if(m_arena)
+        {
+            return std::allocate_shared<T>(arena_allocator<T>(m_arena), std::forward<Args>(args)...);
+        }
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
     inline element::ptr document::root()
     {
         return m_root;
@@ -11,7 +11,8 @@ namespace litehtml
 		explicit el_anchor(const std::shared_ptr<litehtml::document>& doc);
 
 		void	on_click() override;
-		void	apply_stylesheet(const litehtml::css& stylesheet) override;
+		using html_tag::apply_stylesheet;
+		void	apply_stylesheet(const litehtml::css& stylesheet, ancestor_filter& filter) override;
 	};
 }
 
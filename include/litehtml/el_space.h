@@ -9,12 +9,16 @@ namespace litehtml
 	class el_space : public el_text
 	{
 	public:
-		el_space(const char* text, const std::shared_ptr<document>& doc);
+		el_space(tstring_view text, const std::shared_ptr<document>& doc);
 
 		bool is_white_space() const override;
 		bool is_break() const override;
         bool is_space() const override;
         string dump_get_name() override;
+
+		// Preserved spaces can wrap between the characters of a run. Keeps the first character
+		// of such a run and returns the elements for the others; false if nothing is split.
+		bool split_run(elements_list& rest);
 	};
 }
 
@@ -8,13 +8,14 @@ namespace litehtml
 	class el_text : public element
 	{
 	protected:
-		string			m_text;
+		tstring_view	m_text;				// NUL-terminated; points to m_text_storage or into the document's arena
+		string			m_text_storage;
 		string			m_transformed_text;
 		size			m_size;
 		bool			m_use_transformed;
 		bool			m_draw_spaces;
 	public:
-		el_text(const char* text, const document::ptr& doc);
+		el_text(tstring_view text, const document::ptr& doc);
 
 		void				get_text(string& text) override;
 		void				compute_styles(bool recursive) override;
@@ -29,7 +29,7 @@ namespace litehtml
 		std::weak_ptr<element>					m_parent;
 		std::weak_ptr<document>					m_doc;
 		elements_list							m_children;
-		css_properties							m_css;
+		css_properties::ptr						m_css;		// shared with other elements, see css_w()
 		std::list<std::weak_ptr<render_item>>	m_renders;
 		used_selector::vector					m_used_styles;
 
@@ -40,6 +40,7 @@ namespace litehtml
 		virtual ~element() = default;
 
 		const css_properties&		css() const;
+		// returns the style for changing; a style shared with other elements is copied first
 		css_properties&				css_w();
 
 		bool						in_normal_flow()			const;
@@ -78,7 +79,10 @@ namespace litehtml
 
 		virtual void				set_attr(const char* name, const char* val);
 		virtual const char*			get_attr(const char* name, const char* def = nullptr) const;
+		// applies the stylesheet to the subtree; the recursion calls it for every child element
 		virtual void				apply_stylesheet(const litehtml::css& stylesheet);
+		virtual void				apply_stylesheet(const litehtml::css& stylesheet, ancestor_filter& filter);
+		virtual void				update_ancestor_filter(ancestor_filter& filter, bool add) const;
 		virtual void				refresh_styles();
 		virtual bool				is_white_space() const;
 		virtual bool				is_space() const;
@@ -108,6 +112,7 @@ namespace litehtml
 		virtual length_vector		get_length_vector_property(string_id name, bool inherited, const length_vector& default_value, uint_ptr css_properties_member_offset) const;
 		virtual size_vector			get_size_vector_property  (string_id name, bool inherited, const size_vector&   default_value, uint_ptr css_properties_member_offset) const;
 		virtual string				get_custom_property(string_id name, const string& default_value) const;
+		virtual const style*		get_style() const;
 
 		virtual void				get_text(string& text);
 		virtual void				parse_attributes();
@@ -133,6 +138,7 @@ namespace litehtml
 		virtual std::shared_ptr<render_item> create_render_item(const std::shared_ptr<render_item>& parent_ri);
 		bool requires_styles_update();
 		void add_render(const std::shared_ptr<render_item>& ri);
+		void set_needs_layout();	// the element and its subtree are laid out again by document::render_changes()
 		bool find_styles_changes( position::vector& redraw_boxes);
 		element::ptr add_pseudo_before(const style& style)
 		{
@@ -189,12 +195,16 @@ namespace litehtml
 
 	inline const css_properties& element::css() const
 	{
-		return m_css;
+		return *m_css;
 	}
 
 	inline css_properties& element::css_w()
 	{
-		return m_css;
+		if(m_css.use_count() > 1)
+		{
+			m_css = std::make_shared<css_properties>(*m_css);
+		}
+		return *m_css;
 	}
 
 	inline bool element::is_block_box() const
@@ -1,16 +1,86 @@
 #ifndef LITEHTML_FLOATS_HOLDER_H
 #define LITEHTML_FLOATS_HOLDER_H
 
-#include <list>
+#include <vector>
 #include "types.h"
 
 namespace litehtml
 {
+	// Floats of one side sorted by the top. A max-tree of the bottoms in this order finds the
+	// floats crossing a line in logarithmic time instead of walking all of them.
+	class floats_index
+	{
+		std::vector<floated_box>	m_boxes;
+		std::vector<int>			m_max_bottom;				// the leaf of m_boxes[i] is m_max_bottom[m_leaves + i]
+		size_t						m_leaves			= 0;
+		int							m_clear_left_top	= 0;	// the lowest top of the floats with "clear: left/both"
+		int							m_clear_right_top	= 0;	// the lowest top of the floats with "clear: right/both"
+
+	public:
+		typedef std::vector<floated_box>::const_iterator const_iterator;
+
+		bool empty() const				{ return m_boxes.empty(); }
+		const_iterator begin() const	{ return m_boxes.begin(); }
+		const_iterator end() const		{ return m_boxes.end(); }
+
+		void insert(floated_box&& fb);
+		// removes the floats of the context and of the nested ones
+		bool erase_context(int context);
+		// moves the floats of the parent's descendants down by dy
+		bool shift(int dy, const std::shared_ptr<render_item> &parent);
+
+		int max_bottom() const
+		{
+			return m_boxes.empty() || m_max_bottom[1] < 0 ? 0 : m_max_bottom[1];
+		}
+		// the lowest top of the floats that a float of el_float side must be placed below
+		int max_cleared_top(element_float el_float) const
+		{
+			return el_float == float_left ? m_clear_left_top : m_clear_right_top;
+		}
+		// the index of the first float with the top at or below y
+		size_t lower_bound(int y) const;
+		// the index of the first float with the top below y
+		size_t upper_bound(int y) const;
+
+		// calls f for the first count floats with the bottom at or below min_bottom
+		template<class F>
+		void for_each(size_t count, int min_bottom, F f) const
+		{
+			if(count) visit(1, 0, m_leaves, count, min_bottom, f);
+		}
+		// calls f for the floats crossing the line at y
+		template<class F>
+		void for_each_at(int y, F f) const
+		{
+			for_each(upper_bound(y), y + 1, f);
+		}
+
+	private:
+		void rebuild();
+		void update_leaf(size_t idx);
+		void update_cleared_tops(const floated_box& fb);
+
+		template<class F>
+		void visit(size_t node, size_t lo, size_t hi, size_t count, int min_bottom, F& f) const
+		{
+			if(lo >= count || m_max_bottom[node] < min_bottom) return;
+			if(hi - lo == 1)
+			{
+				f(m_boxes[lo]);
+				return;
+			}
+			size_t mid = (lo + hi) / 2;
+			visit(node * 2, lo, mid, count, min_bottom, f);
+			visit(node * 2 + 1, mid, hi, count, min_bottom, f);
+		}
+	};
+
 	class formatting_context
 	{
 	private:
-		std::list<floated_box> m_floats_left;
-		std::list<floated_box> m_floats_right;
+		floats_index m_floats_left;
+		floats_index m_floats_right;
 		int_int_cache m_cache_line_left;
 		int_int_cache m_cache_line_right;
 		int m_current_top;
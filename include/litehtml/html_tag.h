@@ -20,6 +20,7 @@ namespace litehtml
 		friend class el_table;
 		friend class table_grid;
 		friend class line_box;
+		friend class style_sharing_candidates;
 	public:
 		typedef std::shared_ptr<html_tag>	ptr;
 	protected:
@@ -32,6 +33,8 @@ namespace litehtml
 		std::vector<string_id>	m_pseudo_classes;
 
 		void			select_all(const css_selector& selector, elements_list& res) override;
+		// true if el gets the same computed style as this element
+		bool			can_share_style(const html_tag& el) const;
 
 	public:
 		explicit html_tag(const std::shared_ptr<document>& doc);
@@ -49,7 +52,9 @@ namespace litehtml
 
 		void				set_attr(const char* name, const char* val) override;
 		const char*			get_attr(const char* name, const char* def = nullptr) const override;
-		void				apply_stylesheet(const litehtml::css& stylesheet) override;
+		using element::apply_stylesheet;
+		void				apply_stylesheet(const litehtml::css& stylesheet, ancestor_filter& filter) override;
+		void				update_ancestor_filter(ancestor_filter& filter, bool add) const override;
 		void				refresh_styles() override;
 
 		bool				is_white_space() const override;
@@ -69,7 +74,7 @@ namespace litehtml
 		void				draw_background(uint_ptr hdc, int x, int y, const position *clip,
 									const std::shared_ptr<render_item> &ri) override;
 
-		template<class Type, property_type property_value_type, Type property_value::* property_value_member>
+		template<class Type, property_type property_value_type, const Type& (property_value::* property_value_getter)() const>
 		const Type&			get_property_impl  (string_id name, bool inherited, const Type&   default_value, uint_ptr css_properties_member_offset) const;
 		int					get_enum_property  (string_id name, bool inherited, int           default_value, uint_ptr css_properties_member_offset) const override;
 		css_length			get_length_property(string_id name, bool inherited, css_length    default_value, uint_ptr css_properties_member_offset) const override;
@@ -81,6 +86,7 @@ namespace litehtml
 		length_vector		get_length_vector_property(string_id name, bool inherited, const length_vector& default_value, uint_ptr css_properties_member_offset) const override;
 		size_vector			get_size_vector_property  (string_id name, bool inherited, const size_vector&   default_value, uint_ptr css_properties_member_offset) const override;
 		string				get_custom_property(string_id name, const string& default_value) const override;
+		const style*		get_style() const override { return &m_style; }
 
 		elements_list&	children();
 
@@ -121,6 +127,37 @@ namespace litehtml
 		element::ptr		get_element_after(const style& style, bool create);
 	};
 
+	// Children styled so far by the running html_tag::compute_styles loop
+	class style_sharing_candidates
+	{
+		static const int max_count = 8;
+
+		html_tag*			m_items[max_count];
+		int					m_count = 0;
+		css_properties::ptr	m_text_css;
+	public:
+		// returns one of the last html_tag siblings with the same computed style as el
+		html_tag* find(const html_tag& el) const
+		{
+			for(int i = m_count - 1; i >= 0 && i >= m_count - max_count; i--)
+			{
+				html_tag* sibling = m_items[i % max_count];
+				if(sibling->can_share_style(el)) return sibling;
+			}
+			return nullptr;
+		}
+
+		void add(html_tag* el)
+		{
+			m_items[m_count % max_count] = el;
+			m_count++;
+		}
+
+		// style of the text children, which depends only on the parent
+		const css_properties::ptr&	text_css() const					{ return m_text_css; }
+		void						text_css(const css_properties::ptr& css)	{ m_text_css = css; }
+	};
+
 	/************************************************************************/
 	/*                        Inline Functions                              */
 	/************************************************************************/
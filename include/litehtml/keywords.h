@@ -0,0 +1,107 @@
+#ifndef LH_KEYWORDS_H
+#define LH_KEYWORDS_H
+
+#include <vector>
+#include "types.h"
+#include "tstring_view.h"
+
+namespace litehtml
+{
+	// Lookup table for a delimited keyword list such as style_display_strings. The keywords
+	// are placed with a perfect hash, so find() hashes once and compares one candidate.
+	// The table refers to the list text, which must outlive it.
+	class keyword_table
+	{
+		struct slot
+		{
+			const char*	str = nullptr;
+			size_t		len = 0;
+			int			index = -1;
+		};
+
+		std::vector<slot>	m_slots;
+		uint32_t			m_seed = 0;
+		uint32_t			m_mask = 0;
+	public:
+		explicit keyword_table(const char* list, char delim = ';');
+
+		// returns the position of str in the list or defValue
+		int find(tstring_view str, int defValue = -1) const
+		{
+			if(str.empty()) return defValue;
+			const slot& s = m_slots[hash(str.data(), str.size(), m_seed) & m_mask];
+			if(s.len == str.size() && !memcmp(s.str, str.data(), s.len))
+			{
+				return s.index;
+			}
+			return defValue;
+		}
+
+		bool contains(tstring_view str) const
+		{
+			return find(str) >= 0;
+		}
+
+	private:
+		static uint32_t hash(const char* str, size_t len, uint32_t seed)
+		{
+			// FNV-1a
+			uint32_t h = 2166136261u ^ seed;
+			for(size_t i = 0; i < len; i++)
+			{
+				h ^= (unsigned char) str[i];
+				h *= 16777619u;
+			}
+			return h ^ (h >> 15);
+		}
+	};
+
+	// Tables for the keyword lists of types.h, built on first use.
+#define LITEHTML_KEYWORD_LISTS(KEYWORDS)	\
+	KEYWORDS(style_display)					\
+	KEYWORDS(font_size)						\
+	KEYWORDS(line_height)					\
+	KEYWORDS(font_style)					\
+	KEYWORDS(font_variant)					\
+	KEYWORDS(font_weight)					\
+	KEYWORDS(list_style_type)				\
+	KEYWORDS(list_style_position)			\
+	KEYWORDS(vertical_align)				\
+	KEYWORDS(border_width)					\
+	KEYWORDS(border_style)					\
+	KEYWORDS(element_float)					\
+	KEYWORDS(element_clear)					\
+	KEYWORDS(css_units)						\
+	KEYWORDS(background_attachment)			\
+	KEYWORDS(background_repeat)				\
+	KEYWORDS(background_box)				\
+	KEYWORDS(background_position)			\
+	KEYWORDS(element_position)				\
+	KEYWORDS(text_align)					\
+	KEYWORDS(text_transform)				\
+	KEYWORDS(white_space)					\
+	KEYWORDS(overflow)						\
+	KEYWORDS(background_size)				\
+	KEYWORDS(visibility)					\
+	KEYWORDS(border_collapse)				\
+	KEYWORDS(media_orientation)				\
+	KEYWORDS(media_feature)					\
+	KEYWORDS(box_sizing)					\
+	KEYWORDS(media_type)					\
+	KEYWORDS(flex_direction)				\
+	KEYWORDS(flex_wrap)						\
+	KEYWORDS(flex_justify_content)			\
+	KEYWORDS(flex_align_items)				\
+	KEYWORDS(flex_align_self)				\
+	KEYWORDS(flex_align_content)			\
+	KEYWORDS(flex_basis)					\
+	KEYWORDS(caption_side)
+
+#define LITEHTML_KEYWORD_TABLE(name) const keyword_table& name##_keywords();
+	LITEHTML_KEYWORD_LISTS(LITEHTML_KEYWORD_TABLE)
+#undef LITEHTML_KEYWORD_TABLE
+
+	const keyword_table& content_property_keywords();
+}
+
+#endif  // LH_KEYWORDS_H
@@ -0,0 +1,112 @@
+#ifndef LITEHTML_LAYOUT_CACHE_H
+#define LITEHTML_LAYOUT_CACHE_H
+
+#include "types.h"
+
+namespace litehtml
+{
+	// Results of the recent render() calls and content width calculations of a render item, keyed
+	// by the containing block constraints. Entries are valid for one layout pass of the document only.
+	class layout_cache
+	{
+	public:
+		struct entry
+		{
+			containing_block_context	cb_context;
+			bool						second_pass = false;
+			int							generation	= -1;
+			int							ret			= 0;
+			position					pos;		// relative to the x/y passed to render()
+			margins						box_margins;
+			margins						box_padding;
+			margins						box_borders;
+
+			// render() reads only the width, the height and the context index of the containing block,
+			// the rest is recalculated from the item's own style
+			bool matches(const containing_block_context& cb, bool pass, int gen) const
+			{
+				return	generation == gen && second_pass == pass &&
+						same(cb_context.width, cb.width) && same(cb_context.height, cb.height) &&
+						cb_context.context_idx == cb.context_idx;
+			}
+		private:
+			static bool same(const containing_block_context::typed_int& a, const containing_block_context::typed_int& b)
+			{
+				return a.value == b.value && a.type == b.type;
+			}
+		};
+
+		// width calculated by render_item::calc_render_width(), no layout is attached to it
+		struct width_entry
+		{
+			int		cb_width	= 0;
+			int		generation	= -1;
+			int		ret			= 0;
+			int		box_width	= 0;
+		};
+
+	private:
+		static const int cache_size = 4;
+		static const int widths_size = 2;
+
+		entry		m_entries[cache_size];
+		int			m_next		= 0;
+		int			m_current	= -1;	// entry that the render item's subtree is laid out for
+		width_entry	m_widths[widths_size];
+		int			m_next_width = 0;
+	public:
+		entry* find(const containing_block_context& cb, bool second_pass, int generation)
+		{
+			for(auto& e : m_entries)
+			{
+				if(e.matches(cb, second_pass, generation)) return &e;
+			}
+			return nullptr;
+		}
+
+		// the subtree is laid out for this entry
+		bool is_current(const entry* e) const
+		{
+			return m_current >= 0 && e == &m_entries[m_current];
+		}
+
+		// returns the entry to fill for a new render (the found one or the oldest), it becomes the current one
+		entry& store(entry* found)
+		{
+			if(found)
+			{
+				m_current = (int) (found - m_entries);
+			} else
+			{
+				m_current = m_next;
+				m_next = (m_next + 1) % cache_size;
+			}
+			return m_entries[m_current];
+		}
+
+		// the subtree no longer matches any entry
+		void invalidate_current()
+		{
+			m_current = -1;
+		}
+
+		// the width depends only on the width of the containing block
+		const width_entry* find_width(int cb_width, int generation) const
+		{
+			for(const auto& w : m_widths)
+			{
+				if(w.generation == generation && w.cb_width == cb_width) return &w;
+			}
+			return nullptr;
+		}
+
+		width_entry& store_width()
+		{
+			width_entry& ret = m_widths[m_next_width];
+			m_next_width = (m_next_width + 1) % widths_size;
+			return ret;
+		}
+	};
+}
+
+#endif  // LITEHTML_LAYOUT_CACHE_H
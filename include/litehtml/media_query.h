@@ -46,32 +46,15 @@ namespace litehtml
 		typedef std::vector<media_query_list::ptr>	vector;
 	private:
 		media_query::vector	m_queries;
-		bool				m_is_used;
 	public:
-		media_query_list();
-		media_query_list(const media_query_list& val);
+		media_query_list() = default;
+		media_query_list(const media_query_list& val) = default;
 
 		static media_query_list::ptr create_from_string(const string& str, const std::shared_ptr<document>& doc);
-		bool is_used() const;
-		bool apply_media_features(const media_features& features);	// returns true if the m_is_used changed
+		// Media lists can be shared by several documents (see css::get_cached), so whether
+		// a list is in use is tracked by each document, not here.
+		bool check(const media_features& features) const;
 	};
-
-	inline media_query_list::media_query_list(const media_query_list& val)
-	{
-		m_is_used	= val.m_is_used;
-		m_queries	= val.m_queries;
-	}
-
-	inline media_query_list::media_query_list()
-	{
-		m_is_used = false;
-	}
-
-	inline bool media_query_list::is_used() const
-	{
-		return m_is_used;
-	}
-
 }
 
 #endif  // LH_MEDIA_QUERY_H
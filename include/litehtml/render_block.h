@@ -20,6 +20,12 @@ namespace litehtml
          */
         virtual int _render_content(int /*x*/, int /*y*/, bool /*second_pass*/, const containing_block_context &/*self_size*/, formatting_context* /*fmt_ctx*/) {return 0;}
         int _render(int x, int y, const containing_block_context &containing_block_size, formatting_context* fmt_ctx, bool second_pass) override;
+        /**
+         * Calculates the value returned by _render_content() without laying out the content.
+         *
+         * @return false if the content has to be laid out
+         */
+        virtual bool calc_content_width(const containing_block_context &/*self_size*/, int& /*ret*/) {return false;}
         int place_float(const std::shared_ptr<render_item> &el, int top, const containing_block_context &self_size, formatting_context* fmt_ctx);
         virtual void fix_line_width(element_float /*flt*/,
                                     const containing_block_context &/*containing_block_size*/, formatting_context* /*fmt_ctx*/)
@@ -34,6 +40,7 @@ namespace litehtml
             return std::make_shared<render_item_block>(src_el());
         }
         std::shared_ptr<render_item> init() override;
+        bool calc_render_width(const containing_block_context &containing_block_size, int& ret) override;
     };
 }
 
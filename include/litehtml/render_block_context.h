@@ -12,8 +12,13 @@ namespace litehtml
 	 */
 	class render_item_block_context : public render_item_block
 	{
+		int		m_doc_top	= 0;		// top of the content in the document, set by the running layout
+		bool	m_can_defer	= false;	// the layout of the children can be deferred by the lazy layout
+
+		void init_lazy_layout(int y);
 	protected:
 		int _render_content(int x, int y, bool second_pass, const containing_block_context &self_size, formatting_context* fmt_ctx) override;
+		bool calc_content_width(const containing_block_context &self_size, int& ret) override;
 
 	public:
 		explicit render_item_block_context(std::shared_ptr<element>  src_el) : render_item_block(std::move(src_el))
@@ -30,6 +30,7 @@ namespace litehtml
 	protected:
 		std::vector<std::unique_ptr<litehtml::line_box> > m_line_boxes;
 		int m_max_line_width;
+		int m_vertical_shift;	// applied by apply_vertical_align()
 
 		int _render_content(int x, int y, bool second_pass, const containing_block_context &self_size, formatting_context* fmt_ctx) override;
 		void fix_line_width(element_float flt,
@@ -39,8 +40,9 @@ namespace litehtml
 		void place_inline(std::unique_ptr<line_box_item> item, const containing_block_context &self_size, formatting_context* fmt_ctx);
 		int new_box(const std::unique_ptr<line_box_item>& el, line_context& line_ctx, const containing_block_context &self_size, formatting_context* fmt_ctx);
 		void apply_vertical_align() override;
+		bool calc_content_width(const containing_block_context &self_size, int& ret) override;
 	public:
-		explicit render_item_inline_context(std::shared_ptr<element>  src_el) : render_item_block(std::move(src_el)), m_max_line_width(0)
+		explicit render_item_inline_context(std::shared_ptr<element>  src_el) : render_item_block(std::move(src_el)), m_max_line_width(0), m_vertical_shift(0)
 		{}
 
 		std::shared_ptr<render_item> clone() override
@@ -9,6 +9,7 @@
 #include "line_box.h"
 #include "table.h"
 #include "formatting_context.h"
+#include "layout_cache.h"
 
 namespace litehtml
 {
@@ -27,7 +28,13 @@ namespace litehtml
         bool                                        m_selected {};
         bool                                        m_skip;
         std::vector<std::shared_ptr<render_item>>   m_positioned;
+        std::unique_ptr<layout_cache>               m_layout_cache;
+        bool                                        m_needs_layout {};		// the styles of the subtree changed
+        bool                                        m_child_needs_layout {};	// a descendant needs layout
 
+        int cached_render(int x, int y, const containing_block_context& containing_block_size, formatting_context* fmt_ctx, bool second_pass, bool measure_only);
+        int content_width(const containing_block_context& containing_block_size, formatting_context* fmt_ctx);
+        void drop_layout_caches();
         containing_block_context calculate_containing_block_context(const containing_block_context& cb_context);
         void calc_cb_length(const css_length& len, int percent_base, containing_block_context::typed_int& out_value) const;
         virtual int _render(int /*x*/, int /*y*/, const containing_block_context& /*containing_block_size*/, formatting_context* /*fmt_ctx*/, bool /*second_pass*/ = false)
@@ -315,6 +322,28 @@ namespace litehtml
         }
 
         int render(int x, int y, const containing_block_context& containing_block_size, formatting_context* fmt_ctx, bool second_pass = false);
+        // Like render(), but only the returned width and the item's own box are guaranteed to be
+        // up to date. The children can keep an older layout, so render() must follow.
+        int measure(int x, int y, const containing_block_context& containing_block_size, formatting_context* fmt_ctx);
+        // Width returned by render() for the narrowest containing block and for the given one.
+        // The width is calculated without a layout when the content allows it, otherwise these
+        // work like measure(). Only the width of the item's box is guaranteed.
+        int min_content_width(const containing_block_context& containing_block_size, formatting_context* fmt_ctx);
+        int max_content_width(const containing_block_context& containing_block_size, formatting_context* fmt_ctx);
+        // Calculates the width returned by render() and the width of the item's box without laying
+        // out the content. Returns false if the content has to be laid out.
+        virtual bool calc_render_width(const containing_block_context& /*containing_block_size*/, int& /*ret*/)
+        {
+            return false;
+        }
+        // Drops the cached layouts of the subtree and of the ancestors, the next layout of the
+        // document lays them out again
+        void set_needs_layout();
+        void clear_needs_layout();
+        bool needs_layout() const
+        {
+            return m_needs_layout || m_child_needs_layout;
+        }
         int calc_width(int defVal, int containing_block_width) const;
         bool get_predefined_height(int& p_height, int containing_block_height) const;
         void apply_relative_shift(const containing_block_context &containing_block_size);
@@ -4,293 +4,294 @@
 namespace litehtml
 {
 
-#define STRING_ID(...)\
-    enum string_id { __VA_ARGS__ };\
-    const auto initial_string_ids = #__VA_ARGS__;
+// Built-in string ids: the enumerator and the string it is interned as.
+// Both the enum and the string table in string_id.cpp are expanded from this list.
+#define LITEHTML_STRING_IDS(STRING_ID)\
+\
+    /* HTML tags */\
+    STRING_ID(_a_, "a")\
+    STRING_ID(_abbr_, "abbr")\
+    STRING_ID(_acronym_, "acronym")\
+    STRING_ID(_address_, "address")\
+    STRING_ID(_applet_, "applet")\
+    STRING_ID(_area_, "area")\
+    STRING_ID(_article_, "article")\
+    STRING_ID(_aside_, "aside")\
+    STRING_ID(_audio_, "audio")\
+    STRING_ID(_b_, "b")\
+    STRING_ID(_base_, "base")\
+    STRING_ID(_basefont_, "basefont")\
+    STRING_ID(_bdi_, "bdi")\
+    STRING_ID(_bdo_, "bdo")\
+    STRING_ID(_big_, "big")\
+    STRING_ID(_blockquote_, "blockquote")\
+    STRING_ID(_body_, "body")\
+    STRING_ID(_br_, "br")\
+    STRING_ID(_button_, "button")\
+    STRING_ID(_canvas_, "canvas")\
+    STRING_ID(_caption_, "caption")\
+    STRING_ID(_center_, "center")\
+    STRING_ID(_cite_, "cite")\
+    STRING_ID(_code_, "code")\
+    STRING_ID(_col_, "col")\
+    STRING_ID(_colgroup_, "colgroup")\
+    STRING_ID(_data_, "data")\
+    STRING_ID(_datalist_, "datalist")\
+    STRING_ID(_dd_, "dd")\
+    STRING_ID(_del_, "del")\
+    STRING_ID(_details_, "details")\
+    STRING_ID(_dfn_, "dfn")\
+    STRING_ID(_dialog_, "dialog")\
+    STRING_ID(_dir_, "dir")\
+    STRING_ID(_div_, "div")\
+    STRING_ID(_dl_, "dl")\
+    STRING_ID(_dt_, "dt")\
+    STRING_ID(_em_, "em")\
+    STRING_ID(_embed_, "embed")\
+    STRING_ID(_fieldset_, "fieldset")\
+    STRING_ID(_figcaption_, "figcaption")\
+    STRING_ID(_figure_, "figure")\
+    STRING_ID(_footer_, "footer")\
+    STRING_ID(_form_, "form")\
+    STRING_ID(_frame_, "frame")\
+    STRING_ID(_frameset_, "frameset")\
+    STRING_ID(_h1_, "h1")\
+    STRING_ID(_h2_, "h2")\
+    STRING_ID(_h3_, "h3")\
+    STRING_ID(_h4_, "h4")\
+    STRING_ID(_h5_, "h5")\
+    STRING_ID(_h6_, "h6")\
+    STRING_ID(_head_, "head")\
+    STRING_ID(_header_, "header")\
+    STRING_ID(_hr_, "hr")\
+    STRING_ID(_html_, "html")\
+    STRING_ID(_i_, "i")\
+    STRING_ID(_iframe_, "iframe")\
+    STRING_ID(_img_, "img")\
+    STRING_ID(_input_, "input")\
+    STRING_ID(_ins_, "ins")\
+    STRING_ID(_kbd_, "kbd")\
+    STRING_ID(_label_, "label")\
+    STRING_ID(_legend_, "legend")\
+    STRING_ID(_li_, "li")\
+    STRING_ID(_link_, "link")\
+    STRING_ID(_main_, "main")\
+    STRING_ID(_map_, "map")\
+    STRING_ID(_mark_, "mark")\
+    STRING_ID(_meta_, "meta")\
+    STRING_ID(_meter_, "meter")\
+    STRING_ID(_nav_, "nav")\
+    STRING_ID(_noframes_, "noframes")\
+    STRING_ID(_noscript_, "noscript")\
+    STRING_ID(_object_, "object")\
+    STRING_ID(_ol_, "ol")\
+    STRING_ID(_optgroup_, "optgroup")\
+    STRING_ID(_option_, "option")\
+    STRING_ID(_output_, "output")\
+    STRING_ID(_p_, "p")\
+    STRING_ID(_param_, "param")\
+    STRING_ID(_picture_, "picture")\
+    STRING_ID(_pre_, "pre")\
+    STRING_ID(_progress_, "progress")\
+    STRING_ID(_q_, "q")\
+    STRING_ID(_rp_, "rp")\
+    STRING_ID(_rt_, "rt")\
+    STRING_ID(_ruby_, "ruby")\
+    STRING_ID(_s_, "s")\
+    STRING_ID(_samp_, "samp")\
+    STRING_ID(_script_, "script")\
+    STRING_ID(_section_, "section")\
+    STRING_ID(_select_, "select")\
+    STRING_ID(_small_, "small")\
+    STRING_ID(_source_, "source")\
+    STRING_ID(_span_, "span")\
+    STRING_ID(_strike_, "strike")\
+    STRING_ID(_strong_, "strong")\
+    STRING_ID(_style_, "style")\
+    STRING_ID(_sub_, "sub")\
+    STRING_ID(_summary_, "summary")\
+    STRING_ID(_sup_, "sup")\
+    STRING_ID(_svg_, "svg")\
+    STRING_ID(_table_, "table")\
+    STRING_ID(_tbody_, "tbody")\
+    STRING_ID(_td_, "td")\
+    STRING_ID(_template_, "template")\
+    STRING_ID(_textarea_, "textarea")\
+    STRING_ID(_tfoot_, "tfoot")\
+    STRING_ID(_th_, "th")\
+    STRING_ID(_thead_, "thead")\
+    STRING_ID(_time_, "time")\
+    STRING_ID(_title_, "title")\
+    STRING_ID(_tr_, "tr")\
+    STRING_ID(_track_, "track")\
+    STRING_ID(_tt_, "tt")\
+    STRING_ID(_u_, "u")\
+    STRING_ID(_ul_, "ul")\
+    STRING_ID(_var_, "var")\
+    STRING_ID(_video_, "video")\
+    STRING_ID(_wbr_, "wbr")\
+\
+    /* litehtml internal tags */\
+    STRING_ID(__tag_before_, "-tag-before") /* note: real tag cannot start with '-' */\
+    STRING_ID(__tag_after_, "-tag-after")\
+\
+    /* CSS pseudo-elements */\
+    STRING_ID(_before_, "before")\
+    STRING_ID(_after_, "after")\
+\
+    /* CSS pseudo-classes */\
+    STRING_ID(_root_, "root")\
+    STRING_ID(_only_child_, "only-child")\
+    STRING_ID(_only_of_type_, "only-of-type")\
+    STRING_ID(_first_child_, "first-child")\
+    STRING_ID(_first_of_type_, "first-of-type")\
+    STRING_ID(_last_child_, "last-child")\
+    STRING_ID(_last_of_type_, "last-of-type")\
+    STRING_ID(_nth_child_, "nth-child")\
+    STRING_ID(_nth_of_type_, "nth-of-type")\
+    STRING_ID(_nth_last_child_, "nth-last-child")\
+    STRING_ID(_nth_last_of_type_, "nth-last-of-type")\
+    STRING_ID(_not_, "not")\
+    STRING_ID(_lang_, "lang")\
+\
+    STRING_ID(_active_, "active")\
+    STRING_ID(_hover_, "hover")\
+\
+    /* CSS property names */\
+    STRING_ID(_background_, "background")\
+    STRING_ID(_background_color_, "background-color")\
+    STRING_ID(_background_image_, "background-image")\
+    STRING_ID(_background_image_baseurl_, "background-image-baseurl")\
+    STRING_ID(_background_repeat_, "background-repeat")\
+    STRING_ID(_background_origin_, "background-origin")\
+    STRING_ID(_background_clip_, "background-clip")\
+    STRING_ID(_background_attachment_, "background-attachment")\
+    STRING_ID(_background_size_, "background-size")\
+    STRING_ID(_background_position_, "background-position")\
+    STRING_ID(_background_position_x_, "background-position-x")\
+    STRING_ID(_background_position_y_, "background-position-y")\
+\
+    STRING_ID(_border_, "border")\
+    STRING_ID(_border_width_, "border-width")\
+    STRING_ID(_border_style_, "border-style")\
+    STRING_ID(_border_color_, "border-color")\
+\
+    STRING_ID(_border_spacing_, "border-spacing")\
+    STRING_ID(__litehtml_border_spacing_x_, "-litehtml-border-spacing-x")\
+    STRING_ID(__litehtml_border_spacing_y_, "-litehtml-border-spacing-y")\
+\
+    STRING_ID(_border_left_, "border-left")\
+    STRING_ID(_border_right_, "border-right")\
+    STRING_ID(_border_top_, "border-top")\
+    STRING_ID(_border_bottom_, "border-bottom")\
+\
+    STRING_ID(_border_left_style_, "border-left-style")\
+    STRING_ID(_border_right_style_, "border-right-style")\
+    STRING_ID(_border_top_style_, "border-top-style")\
+    STRING_ID(_border_bottom_style_, "border-bottom-style")\
+\
+    STRING_ID(_border_left_width_, "border-left-width")\
+    STRING_ID(_border_right_width_, "border-right-width")\
+    STRING_ID(_border_top_width_, "border-top-width")\
+    STRING_ID(_border_bottom_width_, "border-bottom-width")\
+\
+    STRING_ID(_border_left_color_, "border-left-color")\
+    STRING_ID(_border_right_color_, "border-right-color")\
+    STRING_ID(_border_top_color_, "border-top-color")\
+    STRING_ID(_border_bottom_color_, "border-bottom-color")\
+\
+    STRING_ID(_border_radius_, "border-radius")\
+    STRING_ID(_border_radius_x_, "border-radius-x")\
+    STRING_ID(_border_radius_y_, "border-radius-y")\
+\
+    STRING_ID(_border_bottom_left_radius_, "border-bottom-left-radius")\
+    STRING_ID(_border_bottom_left_radius_x_, "border-bottom-left-radius-x")\
+    STRING_ID(_border_bottom_left_radius_y_, "border-bottom-left-radius-y")\
+\
+    STRING_ID(_border_bottom_right_radius_, "border-bottom-right-radius")\
+    STRING_ID(_border_bottom_right_radius_x_, "border-bottom-right-radius-x")\
+    STRING_ID(_border_bottom_right_radius_y_, "border-bottom-right-radius-y")\
+\
+    STRING_ID(_border_top_left_radius_, "border-top-left-radius")\
+    STRING_ID(_border_top_left_radius_x_, "border-top-left-radius-x")\
+    STRING_ID(_border_top_left_radius_y_, "border-top-left-radius-y")\
+\
+    STRING_ID(_border_top_right_radius_, "border-top-right-radius")\
+    STRING_ID(_border_top_right_radius_x_, "border-top-right-radius-x")\
+    STRING_ID(_border_top_right_radius_y_, "border-top-right-radius-y")\
+\
+    STRING_ID(_list_style_, "list-style")\
+    STRING_ID(_list_style_type_, "list-style-type")\
+    STRING_ID(_list_style_position_, "list-style-position")\
+    STRING_ID(_list_style_image_, "list-style-image")\
+    STRING_ID(_list_style_image_baseurl_, "list-style-image-baseurl")\
+\
+    STRING_ID(_margin_, "margin")\
+    STRING_ID(_margin_left_, "margin-left")\
+    STRING_ID(_margin_right_, "margin-right")\
+    STRING_ID(_margin_top_, "margin-top")\
+    STRING_ID(_margin_bottom_, "margin-bottom")\
+    STRING_ID(_padding_, "padding")\
+    STRING_ID(_padding_left_, "padding-left")\
+    STRING_ID(_padding_right_, "padding-right")\
+    STRING_ID(_padding_top_, "padding-top")\
+    STRING_ID(_padding_bottom_, "padding-bottom")\
+\
+    STRING_ID(_font_, "font")\
+    STRING_ID(_font_family_, "font-family")\
+    STRING_ID(_font_style_, "font-style")\
+    STRING_ID(_font_variant_, "font-variant")\
+    STRING_ID(_font_weight_, "font-weight")\
+    STRING_ID(_font_size_, "font-size")\
+    STRING_ID(_line_height_, "line-height")\
+    STRING_ID(_text_decoration_, "text-decoration")\
+\
+    STRING_ID(_white_space_, "white-space")\
+    STRING_ID(_text_align_, "text-align")\
+    STRING_ID(_vertical_align_, "vertical-align")\
+    STRING_ID(_color_, "color")\
+    STRING_ID(_width_, "width")\
+    STRING_ID(_height_, "height")\
+    STRING_ID(_min_width_, "min-width")\
+    STRING_ID(_min_height_, "min-height")\
+    STRING_ID(_max_width_, "max-width")\
+    STRING_ID(_max_height_, "max-height")\
+    STRING_ID(_position_, "position")\
+    STRING_ID(_overflow_, "overflow")\
+    STRING_ID(_display_, "display")\
+    STRING_ID(_visibility_, "visibility")\
+    STRING_ID(_box_sizing_, "box-sizing")\
+    STRING_ID(_z_index_, "z-index")\
+    STRING_ID(_float_, "float")\
+    STRING_ID(_clear_, "clear")\
+    STRING_ID(_text_indent_, "text-indent")\
+    STRING_ID(_left_, "left")\
+    STRING_ID(_right_, "right")\
+    STRING_ID(_top_, "top")\
+    STRING_ID(_bottom_, "bottom")\
+    STRING_ID(_cursor_, "cursor")\
+    STRING_ID(_content_, "content")\
+    STRING_ID(_border_collapse_, "border-collapse")\
+    STRING_ID(_text_transform_, "text-transform")\
+\
+    STRING_ID(_flex_, "flex")\
+    STRING_ID(_flex_flow_, "flex-flow")\
+    STRING_ID(_flex_direction_, "flex-direction")\
+    STRING_ID(_flex_wrap_, "flex-wrap")\
+    STRING_ID(_justify_content_, "justify-content")\
+    STRING_ID(_align_items_, "align-items")\
+    STRING_ID(_align_content_, "align-content")\
+    STRING_ID(_align_self_, "align-self")\
+    STRING_ID(_flex_grow_, "flex-grow")\
+    STRING_ID(_flex_shrink_, "flex-shrink")\
+    STRING_ID(_flex_basis_, "flex-basis")\
+\
+    STRING_ID(_caption_side_, "caption-side")
 
-STRING_ID(
-
-    // HTML tags
-    _a_,
-    _abbr_,
-    _acronym_,
-    _address_,
-    _applet_,
-    _area_,
-    _article_,
-    _aside_,
-    _audio_,
-    _b_,
-    _base_,
-    _basefont_,
-    _bdi_,
-    _bdo_,
-    _big_,
-    _blockquote_,
-    _body_,
-    _br_,
-    _button_,
-    _canvas_,
-    _caption_,
-    _center_,
-    _cite_,
-    _code_,
-    _col_,
-    _colgroup_,
-    _data_,
-    _datalist_,
-    _dd_,
-    _del_,
-    _details_,
-    _dfn_,
-    _dialog_,
-    _dir_,
-    _div_,
-    _dl_,
-    _dt_,
-    _em_,
-    _embed_,
-    _fieldset_,
-    _figcaption_,
-    _figure_,
-    _footer_,
-    _form_,
-    _frame_,
-    _frameset_,
-    _h1_,
-    _h2_,
-    _h3_,
-    _h4_,
-    _h5_,
-    _h6_,
-    _head_,
-    _header_,
-    _hr_,
-    _html_,
-    _i_,
-    _iframe_,
-    _img_,
-    _input_,
-    _ins_,
-    _kbd_,
-    _label_,
-    _legend_,
-    _li_,
-    _link_,
-    _main_,
-    _map_,
-    _mark_,
-    _meta_,
-    _meter_,
-    _nav_,
-    _noframes_,
-    _noscript_,
-    _object_,
-    _ol_,
-    _optgroup_,
-    _option_,
-    _output_,
-    _p_,
-    _param_,
-    _picture_,
-    _pre_,
-    _progress_,
-    _q_,
-    _rp_,
-    _rt_,
-    _ruby_,
-    _s_,
-    _samp_,
-    _script_,
-    _section_,
-    _select_,
-    _small_,
-    _source_,
-    _span_,
-    _strike_,
-    _strong_,
-    _style_,
-    _sub_,
-    _summary_,
-    _sup_,
-    _svg_,
-    _table_,
-    _tbody_,
-    _td_,
-    _template_,
-    _textarea_,
-    _tfoot_,
-    _th_,
-    _thead_,
-    _time_,
-    _title_,
-    _tr_,
-    _track_,
-    _tt_,
-    _u_,
-    _ul_,
-    _var_,
-    _video_,
-    _wbr_,
-
-    // litehtml internal tags
-    __tag_before_, // note: real tag cannot start with '-'
-    __tag_after_,
-
-    // CSS pseudo-elements
-    _before_,
-    _after_,
-
-    // CSS pseudo-classes
-    _root_,
-    _only_child_,
-    _only_of_type_,
-    _first_child_,
-    _first_of_type_,
-    _last_child_,
-    _last_of_type_,
-    _nth_child_,
-    _nth_of_type_,
-    _nth_last_child_,
-    _nth_last_of_type_,
-    _not_,
-    _lang_,
-
-    _active_,
-    _hover_,
-
-    // CSS property names
-    _background_,
-    _background_color_,
-    _background_image_,
-    _background_image_baseurl_,
-    _background_repeat_,
-    _background_origin_,
-    _background_clip_,
-    _background_attachment_,
-    _background_size_,
-    _background_position_,
-    _background_position_x_,
-    _background_position_y_,
-
-    _border_,
-    _border_width_,
-    _border_style_,
-    _border_color_,
-
-    _border_spacing_,
-    __litehtml_border_spacing_x_,
-    __litehtml_border_spacing_y_,
-
-    _border_left_,
-    _border_right_,
-    _border_top_,
-    _border_bottom_,
-
-    _border_left_style_,
-    _border_right_style_,
-    _border_top_style_,
-    _border_bottom_style_,
-
-    _border_left_width_,
-    _border_right_width_,
-    _border_top_width_,
-    _border_bottom_width_,
-
-    _border_left_color_,
-    _border_right_color_,
-    _border_top_color_,
-    _border_bottom_color_,
-
-    _border_radius_,
-    _border_radius_x_,
-    _border_radius_y_,
-
-    _border_bottom_left_radius_,
-    _border_bottom_left_radius_x_,
-    _border_bottom_left_radius_y_,
-
-    _border_bottom_right_radius_,
-    _border_bottom_right_radius_x_,
-    _border_bottom_right_radius_y_,
-
-    _border_top_left_radius_,
-    _border_top_left_radius_x_,
-    _border_top_left_radius_y_,
-
-    _border_top_right_radius_,
-    _border_top_right_radius_x_,
-    _border_top_right_radius_y_,
-
-    _list_style_,
-    _list_style_type_,
-    _list_style_position_,
-    _list_style_image_,
-    _list_style_image_baseurl_,
-
-    _margin_,
-    _margin_left_,
-    _margin_right_,
-    _margin_top_,
-    _margin_bottom_,
-    _padding_,
-    _padding_left_,
-    _padding_right_,
-    _padding_top_,
-    _padding_bottom_,
-
-    _font_,
-    _font_family_,
-    _font_style_,
-    _font_variant_,
-    _font_weight_,
-    _font_size_,
-    _line_height_,
-    _text_decoration_,
-
-    _white_space_,
-    _text_align_,
-    _vertical_align_,
-    _color_,
-    _width_,
-    _height_,
-    _min_width_,
-    _min_height_,
-    _max_width_,
-    _max_height_,
-    _position_,
-    _overflow_,
-    _display_,
-    _visibility_,
-    _box_sizing_,
-    _z_index_,
-    _float_,
-    _clear_,
-    _text_indent_,
-    _left_,
-    _right_,
-    _top_,
-    _bottom_,
-    _cursor_,
-    _content_,
-    _border_collapse_,
-    _text_transform_,
-
-    _flex_,
-    _flex_flow_,
-    _flex_direction_,
-    _flex_wrap_,
-    _justify_content_,
-    _align_items_,
-    _align_content_,
-    _align_self_,
-    _flex_grow_,
-    _flex_shrink_,
-    _flex_basis_,
-
-    _caption_side_,
-);
+#define STRING_ID(id, name) id,
+enum string_id { LITEHTML_STRING_IDS(STRING_ID) };
 #undef STRING_ID
+
 extern const string_id empty_id; // _id("")
 extern const string_id star_id; // _id("*")
 
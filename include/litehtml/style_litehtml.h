@@ -1,8 +1,12 @@
 #ifndef LH_STYLE_H
 #define LH_STYLE_H
 
+#include <atomic>
+
 namespace litehtml
 {
+    class keyword_table;
+
     enum property_type
     {
         prop_type_invalid, // indicates "not found" condition in style::get_property
@@ -23,44 +27,57 @@ namespace litehtml
 
     class property_value
     {
+        // Strings and vectors are kept out of line in an immutable payload that is
+        // shared by all copies of the value, so copying a declaration never allocates.
+        struct payload_base
+        {
+            std::atomic<int>	m_refs;
+            payload_base() : m_refs(1) {}
+        };
+
+        template<class T>
+        struct payload : payload_base
+        {
+            T	m_value;
+            explicit payload(T&& val) : m_value(std::move(val)) {}
+        };
+
     public:
         property_type	m_type;
         bool			m_important;
 
+    private:
         union {
             int 			m_enum_item;
-            int_vector		m_enum_item_vector;
-            css_length		m_length;
-            length_vector	m_length_vector;
             float			m_number;
             web_color		m_color;
-            string			m_string;
-            string_vector	m_string_vector;
-            size_vector		m_size_vector;
+            css_length		m_length;
+            payload_base*	m_payload;	// payload<T>, where T depends on m_type
         };
 
+    public:
         property_value()
-            : m_type(prop_type_invalid)
+            : m_type(prop_type_invalid), m_important(false)
         {
         }
         property_value(bool important, property_type type)
             : m_type(type), m_important(important)
         {
         }
-        property_value(const string& str, bool important, property_type type = prop_type_string)
-            : m_type(type), m_important(important), m_string(str)
+        property_value(string str, bool important, property_type type = prop_type_string)
+            : m_type(type), m_important(important), m_payload(new payload<string>(std::move(str)))
         {
         }
-        property_value(const string_vector& vec, bool important)
-            : m_type(prop_type_string_vector), m_important(important), m_string_vector(vec)
+        property_value(string_vector vec, bool important)
+            : m_type(prop_type_string_vector), m_important(important), m_payload(new payload<string_vector>(std::move(vec)))
         {
         }
         property_value(const css_length& length, bool important)
             : m_type(prop_type_length), m_important(important), m_length(length)
         {
         }
-        property_value(const length_vector& vec, bool important)
-            : m_type(prop_type_length_vector), m_important(important), m_length_vector(vec)
+        property_value(length_vector vec, bool important)
+            : m_type(prop_type_length_vector), m_important(important), m_payload(new payload<length_vector>(std::move(vec)))
         {
         }
         property_value(float number, bool important)
@@ -71,98 +88,227 @@ namespace litehtml
             : m_type(prop_type_enum_item), m_important(important), m_enum_item(enum_item)
         {
         }
-        property_value(const int_vector& vec, bool important)
-            : m_type(prop_type_enum_item_vector), m_important(important), m_enum_item_vector(vec)
+        property_value(int_vector vec, bool important)
+            : m_type(prop_type_enum_item_vector), m_important(important), m_payload(new payload<int_vector>(std::move(vec)))
         {
         }
         property_value(web_color color, bool important)
             : m_type(prop_type_color), m_important(important), m_color(color)
         {
         }
-        property_value(const size_vector& vec, bool important)
-            : m_type(prop_type_size_vector), m_important(important), m_size_vector(vec)
+        property_value(size_vector vec, bool important)
+            : m_type(prop_type_size_vector), m_important(important), m_payload(new payload<size_vector>(std::move(vec)))
+        {
+        }
+        property_value(const property_value& val)
+            : m_type(prop_type_invalid), m_important(false)
+        {
+            copy_from(val);
+        }
+        property_value(property_value&& val) noexcept
+            : m_type(prop_type_invalid), m_important(false)
         {
+            move_from(val);
         }
         ~property_value()
         {
+            release();
+        }
+        property_value& operator=(const property_value& val)
+        {
+            if (this != &val)
+            {
+                release();
+                copy_from(val);
+            }
+            return *this;
+        }
+        property_value& operator=(property_value&& val) noexcept
+        {
+            if (this != &val)
+            {
+                release();
+                move_from(val);
+            }
+            return *this;
+        }
+
+        // Strings and vectors compare equal when they share the payload, so values copied
+        // from the same declaration are detected without comparing the vectors.
+        bool operator==(const property_value& val) const
+        {
+            if (m_type != val.m_type || m_important != val.m_important) return false;
             switch (m_type)
             {
+            case prop_type_enum_item:	return m_enum_item == val.m_enum_item;
+            case prop_type_number:		return m_number == val.m_number;
+            case prop_type_color:		return m_color == val.m_color;
+            case prop_type_length:		return m_length == val.m_length;
             case prop_type_string:
-            case prop_type_var:
-                m_string.~string();
-                break;
-            case prop_type_string_vector:
-                m_string_vector.~string_vector();
-                break;
-            case prop_type_length:
-                m_length.~css_length();
-                break;
-            case prop_type_length_vector:
-                m_length_vector.~length_vector();
-                break;
-            case prop_type_enum_item_vector:
-                m_enum_item_vector.~int_vector();
-                break;
-            case prop_type_color:
-                m_color.~web_color();
-                break;
-            case prop_type_size_vector:
-                m_size_vector.~size_vector();
-                break;
-
-            case prop_type_enum_item:
-            case prop_type_invalid:
-            case prop_type_inherit:
-            case prop_type_number:;
+            case prop_type_var:			return m_payload == val.m_payload || get_string() == val.get_string();
+            default:					return !has_payload() || m_payload == val.m_payload;
             }
         }
-        property_value& operator=(const property_value& val)
+        bool operator!=(const property_value& val) const { return !(*this == val); }
+
+        const int&				get_enum_item() const			{ return m_enum_item; }
+        const float&			get_number() const				{ return m_number; }
+        const web_color&		get_color() const				{ return m_color; }
+        const css_length&		get_length() const				{ return m_length; }
+        // also the text of prop_type_var
+        const string&			get_string() const				{ return value<string>(); }
+        const string_vector&	get_string_vector() const		{ return value<string_vector>(); }
+        const int_vector&		get_enum_item_vector() const	{ return value<int_vector>(); }
+        const length_vector&	get_length_vector() const		{ return value<length_vector>(); }
+        const size_vector&		get_size_vector() const			{ return value<size_vector>(); }
+
+    private:
+        template<class T>
+        const T& value() const
         {
-            this->~property_value();
+            return static_cast<const payload<T>*>(m_payload)->m_value;
+        }
 
-            switch (val.m_type)
+        bool has_payload() const
+        {
+            switch (m_type)
             {
-            case prop_type_invalid:
-                new(this) property_value();
-                break;
-            case prop_type_inherit:
-                new(this) property_value(val.m_important, val.m_type);
-                break;
             case prop_type_string:
             case prop_type_var:
-                new(this) property_value(val.m_string, val.m_important, val.m_type);
-                break;
             case prop_type_string_vector:
-                new(this) property_value(val.m_string_vector, val.m_important);
-                break;
-            case prop_type_enum_item:
-                new(this) property_value(val.m_enum_item, val.m_important);
-                break;
             case prop_type_enum_item_vector:
-                new(this) property_value(val.m_enum_item_vector, val.m_important);
-                break;
-            case prop_type_length:
-                new(this) property_value(val.m_length, val.m_important);
-                break;
             case prop_type_length_vector:
-                new(this) property_value(val.m_length_vector, val.m_important);
+            case prop_type_size_vector:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void copy_from(const property_value& val)
+        {
+            m_type		= val.m_type;
+            m_important	= val.m_important;
+            switch (m_type)
+            {
+            case prop_type_enum_item:
+                m_enum_item = val.m_enum_item;
                 break;
             case prop_type_number:
-                new(this) property_value(val.m_number, val.m_important);
+                m_number = val.m_number;
                 break;
             case prop_type_color:
-                new(this) property_value(val.m_color, val.m_important);
+                new(&m_color) web_color(val.m_color);
                 break;
-            case prop_type_size_vector:
-                new(this) property_value(val.m_size_vector, val.m_important);
+            case prop_type_length:
+                new(&m_length) css_length(val.m_length);
                 break;
+            default:
+                if (val.has_payload())
+                {
+                    m_payload = val.m_payload;
+                    m_payload->m_refs.fetch_add(1, std::memory_order_relaxed);
+                }
             }
+        }
 
-            return *this;
+        void move_from(property_value& val)
+        {
+            if (val.has_payload())
+            {
+                m_type		= val.m_type;
+                m_important	= val.m_important;
+                m_payload	= val.m_payload;
+                val.m_type	= prop_type_invalid;
+            } else
+            {
+                copy_from(val);
+            }
+        }
+
+        void release()
+        {
+            if (has_payload() && m_payload->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                switch (m_type)
+                {
+                case prop_type_string:
+                case prop_type_var:
+                    delete static_cast<payload<string>*>(m_payload);
+                    break;
+                case prop_type_string_vector:
+                    delete static_cast<payload<string_vector>*>(m_payload);
+                    break;
+                case prop_type_enum_item_vector:
+                    delete static_cast<payload<int_vector>*>(m_payload);
+                    break;
+                case prop_type_length_vector:
+                    delete static_cast<payload<length_vector>*>(m_payload);
+                    break;
+                case prop_type_size_vector:
+                    delete static_cast<payload<size_vector>*>(m_payload);
+                    break;
+                default:;
+                }
+            }
+            m_type = prop_type_invalid;
         }
     };
 
-    typedef std::map<string_id, property_value>	props_map;
+    // Declarations of a style, kept sorted by property id in one contiguous vector.
+    // Styles hold few declarations, so binary search over a flat array beats a tree
+    // for lookups, and copying or cascading styles needs no per-node allocations.
+    class props_map
+    {
+    public:
+        typedef std::pair<string_id, property_value>	value_type;
+        typedef std::vector<value_type>					container;
+        typedef container::iterator						iterator;
+        typedef container::const_iterator				const_iterator;
+    private:
+        container	m_items;
+    public:
+        iterator		begin()			{ return m_items.begin(); }
+        iterator		end()			{ return m_items.end(); }
+        const_iterator	begin() const	{ return m_items.begin(); }
+        const_iterator	end() const		{ return m_items.end(); }
+        size_t			size() const	{ return m_items.size(); }
+        bool			empty() const	{ return m_items.empty(); }
+        void			clear()			{ m_items.clear(); }
+        void			erase(iterator it)	{ m_items.erase(it); }
+        container&		items()			{ return m_items; }
+        const container& items() const	{ return m_items; }
+
+        iterator lower_bound(string_id name)
+        {
+            return std::lower_bound(m_items.begin(), m_items.end(), name,
+                [](const value_type& item, string_id id) { return item.first < id; });
+        }
+        const_iterator lower_bound(string_id name) const
+        {
+            return std::lower_bound(m_items.begin(), m_items.end(), name,
+                [](const value_type& item, string_id id) { return item.first < id; });
+        }
+        iterator find(string_id name)
+        {
+            auto it = lower_bound(name);
+            return it != m_items.end() && it->first == name ? it : m_items.end();
+        }
+        const_iterator find(string_id name) const
+        {
+            auto it = lower_bound(name);
+            return it != m_items.end() && it->first == name ? it : m_items.end();
+        }
+        property_value& operator[](string_id name)
+        {
+            auto it = lower_bound(name);
+            if (it == m_items.end() || it->first != name)
+            {
+                it = m_items.insert(it, value_type(name, property_value()));
+            }
+            return it->second;
+        }
+    };
 
     class style
     {
@@ -171,18 +317,24 @@ namespace litehtml
         typedef std::vector<style::ptr>		vector;
     private:
         props_map							m_properties;
-        static std::map<string_id, string>	m_valid_values;
+        static std::map<string_id, const keyword_table*>	m_valid_values;
     public:
         void add(const string& txt, const string& baseurl = "", document_container* container = nullptr)
         {
-            parse(txt, baseurl, container);
+            parse(txt.data(), txt.data() + txt.size(), baseurl, container);
+        }
+        void add(const char* begin, const char* end, const string& baseurl = "", document_container* container = nullptr)
+        {
+            parse(begin, end, baseurl, container);
         }
 
         void add_property(string_id name, const string& val, const string& baseurl = "", bool important = false, document_container* container = nullptr);
 
         const property_value& get_property(string_id name) const;
+        const props_map& properties() const { return m_properties; }
 
         void combine(const style& src);
+        bool operator==(const style& val) const { return m_properties.items() == val.m_properties.items(); }
         void clear()
         {
             m_properties.clear();
@@ -191,8 +343,8 @@ namespace litehtml
         void subst_vars(const element* el);
 
     private:
-        void parse_property(const string& txt, const string& baseurl, document_container* container);
-        void parse(const string& txt, const string& baseurl, document_container* container);
+        void parse_property(const char* begin, const char* end, const string& baseurl, document_container* container);
+        void parse(const char* begin, const char* end, const string& baseurl, document_container* container);
         void parse_background(const string& val, const string& baseurl, bool important, document_container* container);
         bool parse_one_background(const string& val, document_container* container, background& bg);
         void parse_background_image(const string& val, const string& baseurl, bool important);
@@ -3,6 +3,7 @@
 
 #include "style_litehtml.h"
 #include "css_selector.h"
+#include <unordered_map>
 
 namespace litehtml
 {
@@ -10,8 +11,20 @@ namespace litehtml
 
 	class css
 	{
+		typedef std::unordered_map<string_id, std::vector<int>>	selectors_index;
+
 		css_selector::vector	m_selectors;
+		// Positions in m_selectors bucketed by the rightmost compound selector.
+		// Built by sort_selectors(), so each bucket is in specificity/order sequence.
+		selectors_index			m_id_index;
+		selectors_index			m_class_index;
+		selectors_index			m_tag_index;
+		std::vector<int>		m_universal_index;
+		bool					m_indexed = false;
+		bool					m_has_imports = false;
 	public:
+		typedef std::shared_ptr<const css>	const_ptr;
+
 		css() = default;
 		~css() = default;
 
@@ -23,14 +36,33 @@ namespace litehtml
 		void clear()
 		{
 			m_selectors.clear();
+			clear_index();
 		}
 
 		void	parse_stylesheet(const char* str, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
+		// appends the selectors of src, which may be shared with other stylesheets
+		void	add_selectors(const css& src);
 		void	sort_selectors();
+		void	get_candidates(string_id tag, string_id id, const std::vector<string_id>& classes, std::vector<int>& res) const;
 		static void	parse_css_url(const string& str, string& url);
 
+		// Returns the parsed and sorted stylesheet from a process-wide cache, parsing it on
+		// the first request. Entries are keyed by the text, base url, media and the document
+		// container (colors and media lengths are resolved through it). The returned object
+		// must not be modified; media lists of its selectors must be added to the document.
+		static const_ptr	get_cached(const char* str, const char* baseurl, const char* media, const std::shared_ptr<document>& doc);
+		// drops all cached stylesheets
+		static void			clear_cache();
+		// drops the stylesheets cached for the container, called by ~document_container()
+		static void			clear_cache(const document_container* container);
+		// litehtml::master_css, parsed once per process and shared by all documents
+		static const_ptr	default_master();
+
 	private:
-		void	parse_atrule(const string& text, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
+		void	build_index();
+		void	clear_index();
+		void	parse_rules(const char* begin, const char* end, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
+		void	parse_atrule(const char* begin, const char* end, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media);
 		void	add_selector(const css_selector::ptr& selector);
 		bool	parse_selectors(const string& txt, const style::ptr& styles, const media_query_list::ptr& media);
 
@@ -40,6 +72,7 @@ namespace litehtml
 	{
 		selector->m_order = (int) m_selectors.size();
 		m_selectors.push_back(selector);
+		m_indexed = false;
 	}
 
 }
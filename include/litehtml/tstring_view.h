@@ -31,7 +31,9 @@
 #define LITEHTML_TSTRING_VIEW_H__
 
 #include <cstddef>
+#include <cstring>
 #include <ostream>
+#include <string>
 
 #include "os_types.h"
 
@@ -76,6 +78,18 @@ public:
     {
     }
 
+    tstring_view(const_pointer s)
+    : data_(s)
+    , size_(s ? strlen(s) : 0)
+    {
+    }
+
+    tstring_view(const std::basic_string<value_type>& s)
+    : data_(s.data())
+    , size_(s.size())
+    {
+    }
+
     constexpr const_iterator begin() const
     {
         return data_;
@@ -127,6 +141,16 @@ private:
     size_type size_ = 0;
 };
 
+inline bool operator==(tstring_view lhs, tstring_view rhs)
+{
+    return lhs.size() == rhs.size() && (lhs.size() == 0 || memcmp(lhs.data(), rhs.data(), lhs.size()) == 0);
+}
+
+inline bool operator!=(tstring_view lhs, tstring_view rhs)
+{
+    return !(lhs == rhs);
+}
+
 std::basic_ostream<tstring_view::value_type>& operator<<(
     std::basic_ostream<tstring_view::value_type>&,
     tstring_view str);
@@ -174,8 +174,6 @@ namespace litehtml
         font_metrics	metrics;
     };
 
-    typedef std::map<std::string, font_item> fonts_map;
-
     enum draw_flag
     {
         draw_root,
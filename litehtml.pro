@@ -9,6 +9,7 @@ HEADERS += \
     containers/qt/qt_container.h \
     containers/qt/qt_litehtml.h \
     include/litehtml.h \
+    include/litehtml/arena.h \
     include/litehtml/background.h \
     include/litehtml/borders.h \
     include/litehtml/codepoint.h \
@@ -18,6 +19,8 @@ HEADERS += \
     include/litehtml/css_position.h \
     include/litehtml/css_properties.h \
     include/litehtml/css_selector.h \
+    include/litehtml/css_tokenizer.h \
+    include/litehtml/keywords.h \
     include/litehtml/document_container.h \
     include/litehtml/document_litehtml.h \
     include/litehtml/el_anchor.h \
@@ -45,6 +48,7 @@ HEADERS += \
     include/litehtml/html.h \
     include/litehtml/html_tag.h \
     include/litehtml/iterators.h \
+    include/litehtml/layout_cache.h \
     include/litehtml/line_box.h \
     include/litehtml/master_css.h \
     include/litehtml/media_query.h \
@@ -96,6 +100,8 @@ SOURCES += \
     src/css_length.cpp \
     src/css_properties.cpp \
     src/css_selector.cpp \
+    src/css_tokenizer.cpp \
+    src/keywords.cpp \
     src/document_container.cpp \
     src/document_litehtml.cpp \
     src/el_anchor.cpp \
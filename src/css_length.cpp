@@ -1,59 +1,109 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/css_length.h"
+#include "../include/litehtml/keywords.h"
 
-void litehtml::css_length::fromString( const string& str, const string& predefs, int defValue )
+namespace
 {
-    // TODO: Make support for calc
-    if(str.substr(0, 4) == "calc")
+    constexpr uint32_t unit_key(char c0, char c1 = 0, char c2 = 0, char c3 = 0)
     {
-        m_is_predefined = true;
-        m_predef		= defValue;
-        return;
+        return (uint32_t) (unsigned char) c0 | (uint32_t) (unsigned char) c1 << 8 |
+               (uint32_t) (unsigned char) c2 << 16 | (uint32_t) (unsigned char) c3 << 24;
     }
 
-    int predef = value_index(str, predefs, -1);
-    if(predef >= 0)
-    {
-        m_is_predefined = true;
-        m_predef		= predef;
-    } else
+    // All units are 1-4 characters long, so the lowercased characters packed into one
+    // integer are a collision-free key.
+    litehtml::css_units units_from_string(const char* str, size_t len)
     {
-        m_is_predefined = false;
+        using namespace litehtml;
+        if(len == 0 || len > 4) return css_units_none;
 
-        string num;
-        string un;
-        bool is_unit = false;
-        for(char chr : str)
+        char c[4] = {0, 0, 0, 0};
+        for(size_t i = 0; i < len; i++)
         {
-            if(!is_unit)
-            {
-                if(t_isdigit(chr) || chr == '.' || chr == '+' || chr == '-')
-                {
-                    num += chr;
-                } else
-                {
-                    is_unit = true;
-                }
-            }
-            if(is_unit)
-            {
-                un += chr;
-            }
+            c[i] = (char) t_tolower(str[i]);
         }
-        if(!num.empty())
+        switch(unit_key(c[0], c[1], c[2], c[3]))
         {
-            m_value = t_strtof(num);
-            m_units	= (css_units) value_index(un, css_units_strings, css_units_none);
-        } else
-        {
-            // not a number so it is predefined
-            m_is_predefined = true;
-            m_predef = defValue;
+        case unit_key('%'):				return css_units_percentage;
+        case unit_key('i', 'n'):			return css_units_in;
+        case unit_key('c', 'm'):			return css_units_cm;
+        case unit_key('m', 'm'):			return css_units_mm;
+        case unit_key('e', 'm'):			return css_units_em;
+        case unit_key('e', 'x'):			return css_units_ex;
+        case unit_key('p', 't'):			return css_units_pt;
+        case unit_key('p', 'c'):			return css_units_pc;
+        case unit_key('p', 'x'):			return css_units_px;
+        case unit_key('d', 'p', 'i'):		return css_units_dpi;
+        case unit_key('d', 'p', 'c', 'm'):	return css_units_dpcm;
+        case unit_key('v', 'w'):			return css_units_vw;
+        case unit_key('v', 'h'):			return css_units_vh;
+        case unit_key('v', 'm', 'i', 'n'):	return css_units_vmin;
+        case unit_key('v', 'm', 'a', 'x'):	return css_units_vmax;
+        case unit_key('r', 'e', 'm'):		return css_units_rem;
+        default:						return css_units_none;
         }
     }
+
+    inline bool is_number_char(char chr)
+    {
+        return litehtml::t_isdigit(chr) || chr == '.' || chr == '+' || chr == '-';
+    }
+}
+
+void litehtml::css_length::fromString( tstring_view str, const string& predefs, int defValue )
+{
+    if(parse_number(str, defValue)) return;
+    predef(str.empty() ? defValue : value_index(string(str.data(), str.size()), predefs, defValue));
+}
+
+void litehtml::css_length::fromString( tstring_view str, const keyword_table& predefs, int defValue )
+{
+    if(parse_number(str, defValue)) return;
+    predef(predefs.find(str, defValue));
+}
+
+bool litehtml::css_length::parse_number( tstring_view str, int defValue )
+{
+    // TODO: Make support for calc
+    if(str.size() >= 5 && !t_strncasecmp(str.data(), "calc(", 5))
+    {
+        predef(defValue);
+        return true;
+    }
+
+    // keywords never start like a number, so numbers skip the keyword lookup
+    if(str.empty() || !is_number_char(str[0]))
+    {
+        return false;
+    }
+
+    size_t num_len = 1;
+    while(num_len < str.size() && is_number_char(str[num_len])) num_len++;
+
+    // t_strtod needs a terminated string; numbers are short enough for a stack buffer
+    char buf[32];
+    if(num_len < sizeof(buf))
+    {
+        memcpy(buf, str.data(), num_len);
+        buf[num_len] = 0;
+        m_value = (float) t_strtod(buf);
+    } else
+    {
+        m_value = t_strtof(string(str.data(), num_len));
+    }
+    m_is_predefined = false;
+    m_units			= units_from_string(str.data() + num_len, str.size() - num_len);
+    return true;
+}
+
+litehtml::css_length litehtml::css_length::from_string(tstring_view str, const string& predefs, int defValue)
+{
+    css_length len;
+    len.fromString(str, predefs, defValue);
+    return len;
 }
 
-litehtml::css_length litehtml::css_length::from_string(const string& str, const string& predefs, int defValue)
+litehtml::css_length litehtml::css_length::from_string(tstring_view str, const keyword_table& predefs, int defValue)
 {
     css_length len;
     len.fromString(str, predefs, defValue);
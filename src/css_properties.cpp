@@ -2,26 +2,49 @@
 #include "../include/litehtml/css_properties.h"
 #include <cmath>
 
-#define offset(member) ((uint_ptr)&this->member - (uint_ptr)this)
+namespace
+{
+    using namespace litehtml;
+
+    // Sets the field from a declared value of the expected type. "inherit" takes the parent's
+    // value; other values are ignored, so the field keeps its inherited or initial value.
+    // Returns true if the field was set.
+    template<class T, class V>
+    inline bool apply(T& field, const property_value& val, property_type type, const V& (property_value::*getter)() const, const T* parent_field)
+    {
+        if (val.m_type == type)
+        {
+            field = (T) (val.*getter)();
+            return true;
+        }
+        if (val.m_type == prop_type_inherit && parent_field)
+        {
+            field = *parent_field;
+            return true;
+        }
+        return false;
+    }
+}
+
+const litehtml::css_properties::ptr& litehtml::css_properties::initial()
+{
+    static const ptr css = std::make_shared<css_properties>();
+    return css;
+}
 
 void litehtml::css_properties::compute(const element* el, const document::ptr& doc)
 {
-    compute_font(el, doc);
+    element::ptr el_parent = el->parent();
+    const css_properties* parent = el_parent ? &el_parent->css() : nullptr;
+
+    init(parent, doc);
+    if (const style* st = el->get_style())
+    {
+        cascade(*st, parent);
+    }
+
+    compute_font(parent, doc);
     int font_size = get_font_size();
-    m_color = el->get_color_property(_color_, true, web_color::black, offset(m_color));
-
-    m_el_position	 = (element_position) el->get_enum_property( _position_,		false,	element_position_static, offset(m_el_position));
-    m_display		 = (style_display)	  el->get_enum_property( _display_,			false,	display_inline,			 offset(m_display));
-    m_visibility	 = (visibility)		  el->get_enum_property( _visibility_,		true,	visibility_visible,		 offset(m_visibility));
-    m_float			 = (element_float)	  el->get_enum_property( _float_,			false,	float_none,				 offset(m_float));
-    m_clear			 = (element_clear)	  el->get_enum_property( _clear_,			false,	clear_none,				 offset(m_clear));
-    m_box_sizing	 = (box_sizing)		  el->get_enum_property( _box_sizing_,		false,	box_sizing_content_box,	 offset(m_box_sizing));
-    m_overflow		 = (overflow)		  el->get_enum_property( _overflow_,		false,	overflow_visible,		 offset(m_overflow));
-    m_text_align	 = (text_align)		  el->get_enum_property( _text_align_,		true,	text_align_left,		 offset(m_text_align));
-    m_vertical_align = (vertical_align)	  el->get_enum_property( _vertical_align_,	false,	va_baseline,			 offset(m_vertical_align));
-    m_text_transform = (text_transform)	  el->get_enum_property( _text_transform_,	true,	text_transform_none,	 offset(m_text_transform));
-    m_white_space	 = (white_space)	  el->get_enum_property( _white_space_,		true,	white_space_normal,		 offset(m_white_space));
-    m_caption_side	 = (caption_side)	  el->get_enum_property( _caption_side_,	true,	caption_side_top,		 offset(m_caption_side));
 
     // https://www.w3.org/TR/CSS22/visuren.html#dis-pos-flo
     if (m_display == display_none)
@@ -101,18 +124,6 @@ void litehtml::css_properties::compute(const element* el, const document::ptr& d
     }
     // 5. Otherwise, the remaining 'display' property values apply as specified.
 
-    const css_length _auto = css_length::predef_value(0);
-    const css_length _none = _auto, normal = _auto;
-
-    m_css_width      = el->get_length_property(_width_,      false, _auto, offset(m_css_width));
-    m_css_height     = el->get_length_property(_height_,     false, _auto, offset(m_css_height));
-
-    m_css_min_width  = el->get_length_property(_min_width_,  false, _auto, offset(m_css_min_width));
-    m_css_min_height = el->get_length_property(_min_height_, false, _auto, offset(m_css_min_height));
-
-    m_css_max_width  = el->get_length_property(_max_width_,  false, _none, offset(m_css_max_width));
-    m_css_max_height = el->get_length_property(_max_height_, false, _none, offset(m_css_max_height));
-
     doc->cvt_units(m_css_width, font_size);
     doc->cvt_units(m_css_height, font_size);
 
@@ -122,41 +133,16 @@ void litehtml::css_properties::compute(const element* el, const document::ptr& d
     doc->cvt_units(m_css_max_width, font_size);
     doc->cvt_units(m_css_max_height, font_size);
 
-    m_css_margins.left   = el->get_length_property(_margin_left_,   false, 0, offset(m_css_margins.left));
-    m_css_margins.right  = el->get_length_property(_margin_right_,  false, 0, offset(m_css_margins.right));
-    m_css_margins.top    = el->get_length_property(_margin_top_,    false, 0, offset(m_css_margins.top));
-    m_css_margins.bottom = el->get_length_property(_margin_bottom_, false, 0, offset(m_css_margins.bottom));
-
     doc->cvt_units(m_css_margins.left,	 font_size);
     doc->cvt_units(m_css_margins.right,	 font_size);
     doc->cvt_units(m_css_margins.top,	 font_size);
     doc->cvt_units(m_css_margins.bottom, font_size);
 
-    m_css_padding.left   = el->get_length_property(_padding_left_,   false, 0, offset(m_css_padding.left));
-    m_css_padding.right  = el->get_length_property(_padding_right_,  false, 0, offset(m_css_padding.right));
-    m_css_padding.top    = el->get_length_property(_padding_top_,    false, 0, offset(m_css_padding.top));
-    m_css_padding.bottom = el->get_length_property(_padding_bottom_, false, 0, offset(m_css_padding.bottom));
-
     doc->cvt_units(m_css_padding.left,	 font_size);
     doc->cvt_units(m_css_padding.right,	 font_size);
     doc->cvt_units(m_css_padding.top,	 font_size);
     doc->cvt_units(m_css_padding.bottom, font_size);
 
-    m_css_borders.left.color   = el->get_color_property(_border_left_color_,   false, m_color, offset(m_css_borders.left.color));
-    m_css_borders.right.color  = el->get_color_property(_border_right_color_,  false, m_color, offset(m_css_borders.right.color));
-    m_css_borders.top.color    = el->get_color_property(_border_top_color_,    false, m_color, offset(m_css_borders.top.color));
-    m_css_borders.bottom.color = el->get_color_property(_border_bottom_color_, false, m_color, offset(m_css_borders.bottom.color));
-
-    m_css_borders.left.style   = (border_style) el->get_enum_property(_border_left_style_,   false, border_style_none, offset(m_css_borders.left.style));
-    m_css_borders.right.style  = (border_style) el->get_enum_property(_border_right_style_,  false, border_style_none, offset(m_css_borders.right.style));
-    m_css_borders.top.style    = (border_style) el->get_enum_property(_border_top_style_,    false, border_style_none, offset(m_css_borders.top.style));
-    m_css_borders.bottom.style = (border_style) el->get_enum_property(_border_bottom_style_, false, border_style_none, offset(m_css_borders.bottom.style));
-
-    m_css_borders.left.width   = el->get_length_property(_border_left_width_,   false, border_width_medium_value, offset(m_css_borders.left.width));
-    m_css_borders.right.width  = el->get_length_property(_border_right_width_,  false, border_width_medium_value, offset(m_css_borders.right.width));
-    m_css_borders.top.width    = el->get_length_property(_border_top_width_,    false, border_width_medium_value, offset(m_css_borders.top.width));
-    m_css_borders.bottom.width = el->get_length_property(_border_bottom_width_, false, border_width_medium_value, offset(m_css_borders.bottom.width));
-
     if (m_css_borders.left.style == border_style_none || m_css_borders.left.style == border_style_hidden)
         m_css_borders.left.width = 0;
     if (m_css_borders.right.style == border_style_none || m_css_borders.right.style == border_style_hidden)
@@ -171,18 +157,6 @@ void litehtml::css_properties::compute(const element* el, const document::ptr& d
     doc->cvt_units(m_css_borders.top.width,		font_size);
     doc->cvt_units(m_css_borders.bottom.width,	font_size);
 
-    m_css_borders.radius.top_left_x = el->get_length_property(_border_top_left_radius_x_, false, 0, offset(m_css_borders.radius.top_left_x));
-    m_css_borders.radius.top_left_y = el->get_length_property(_border_top_left_radius_y_, false, 0, offset(m_css_borders.radius.top_left_y));
-
-    m_css_borders.radius.top_right_x = el->get_length_property(_border_top_right_radius_x_, false, 0, offset(m_css_borders.radius.top_right_x));
-    m_css_borders.radius.top_right_y = el->get_length_property(_border_top_right_radius_y_, false, 0, offset(m_css_borders.radius.top_right_y));
-
-    m_css_borders.radius.bottom_left_x = el->get_length_property(_border_bottom_left_radius_x_, false, 0, offset(m_css_borders.radius.bottom_left_x));
-    m_css_borders.radius.bottom_left_y = el->get_length_property(_border_bottom_left_radius_y_, false, 0, offset(m_css_borders.radius.bottom_left_y));
-
-    m_css_borders.radius.bottom_right_x = el->get_length_property(_border_bottom_right_radius_x_, false, 0, offset(m_css_borders.radius.bottom_right_x));
-    m_css_borders.radius.bottom_right_y = el->get_length_property(_border_bottom_right_radius_y_, false, 0, offset(m_css_borders.radius.bottom_right_y));
-
     doc->cvt_units( m_css_borders.radius.top_left_x,			font_size);
     doc->cvt_units( m_css_borders.radius.top_left_y,			font_size);
     doc->cvt_units( m_css_borders.radius.top_right_x,			font_size);
@@ -192,32 +166,16 @@ void litehtml::css_properties::compute(const element* el, const document::ptr& d
     doc->cvt_units( m_css_borders.radius.bottom_right_x,		font_size);
     doc->cvt_units( m_css_borders.radius.bottom_right_y,		font_size);
 
-    m_border_collapse = (border_collapse) el->get_enum_property(_border_collapse_, true, border_collapse_separate, offset(m_border_collapse));
-
-    m_css_border_spacing_x = el->get_length_property(__litehtml_border_spacing_x_, true, 0, offset(m_css_border_spacing_x));
-    m_css_border_spacing_y = el->get_length_property(__litehtml_border_spacing_y_, true, 0, offset(m_css_border_spacing_y));
-
     doc->cvt_units(m_css_border_spacing_x, font_size);
     doc->cvt_units(m_css_border_spacing_y, font_size);
 
-    m_css_offsets.left	 = el->get_length_property(_left_,	false, _auto, offset(m_css_offsets.left));
-    m_css_offsets.right  = el->get_length_property(_right_, false, _auto, offset(m_css_offsets.right));
-    m_css_offsets.top	 = el->get_length_property(_top_,	false, _auto, offset(m_css_offsets.top));
-    m_css_offsets.bottom = el->get_length_property(_bottom_,false, _auto, offset(m_css_offsets.bottom));
-
     doc->cvt_units(m_css_offsets.left,   font_size);
     doc->cvt_units(m_css_offsets.right,  font_size);
     doc->cvt_units(m_css_offsets.top,    font_size);
     doc->cvt_units(m_css_offsets.bottom, font_size);
 
-    m_z_index = el->get_length_property(_z_index_, false, _auto, offset(m_z_index));
-    m_content = el->get_string_property(_content_, false, "", offset(m_content));
-    m_cursor = el->get_string_property(_cursor_, true, "auto", offset(m_cursor));
-
-    m_css_text_indent = el->get_length_property(_text_indent_, true, 0, offset(m_css_text_indent));
     doc->cvt_units(m_css_text_indent, font_size);
 
-    m_css_line_height = el->get_length_property(_line_height_, true, normal, offset(m_css_line_height));
     if(m_css_line_height.is_predefined())
     {
         m_line_height = m_font_metrics.height;
@@ -230,18 +188,273 @@ void litehtml::css_properties::compute(const element* el, const document::ptr& d
         m_css_line_height = (float) m_line_height;
     }
 
-    m_list_style_type     = (list_style_type)     el->get_enum_property(_list_style_type_,     true, list_style_type_disc,        offset(m_list_style_type));
-    m_list_style_position = (list_style_position) el->get_enum_property(_list_style_position_, true, list_style_position_outside, offset(m_list_style_position));
-
-    m_list_style_image = el->get_string_property(_list_style_image_, true, "", offset(m_list_style_image));
     if (!m_list_style_image.empty())
     {
-        m_list_style_image_baseurl = el->get_string_property(_list_style_image_baseurl_, true, "", offset(m_list_style_image_baseurl));
         doc->container()->load_image(m_list_style_image.c_str(), m_list_style_image_baseurl.c_str(), true);
     }
 
-    compute_background(el, doc);
-    compute_flex(el, doc);
+    compute_background(doc);
+    compute_flex(parent, doc);
+}
+
+// Starts from the parent's values of the inherited properties and the initial values of the others.
+void litehtml::css_properties::init(const css_properties* parent, const document::ptr& doc)
+{
+    if (parent)
+    {
+        m_color					= parent->m_color;
+        m_visibility			= parent->m_visibility;
+        m_text_align			= parent->m_text_align;
+        m_text_transform		= parent->m_text_transform;
+        m_white_space			= parent->m_white_space;
+        m_caption_side			= parent->m_caption_side;
+        m_border_collapse		= parent->m_border_collapse;
+        m_css_border_spacing_x	= parent->m_css_border_spacing_x;
+        m_css_border_spacing_y	= parent->m_css_border_spacing_y;
+        m_cursor				= parent->m_cursor;
+        m_css_text_indent		= parent->m_css_text_indent;
+        m_css_line_height		= parent->m_css_line_height;
+        m_list_style_type		= parent->m_list_style_type;
+        m_list_style_position	= parent->m_list_style_position;
+        m_list_style_image		= parent->m_list_style_image;
+        m_list_style_image_baseurl = parent->m_list_style_image_baseurl;
+        m_font_size				= parent->m_font_size;
+        m_font_family			= parent->m_font_family;
+        m_font_weight			= parent->m_font_weight;
+        m_font_style			= parent->m_font_style;
+        m_text_decoration		= parent->m_text_decoration;
+    } else
+    {
+        m_color					= web_color::black;
+        m_visibility			= visibility_visible;
+        m_text_align			= text_align_left;
+        m_text_transform		= text_transform_none;
+        m_white_space			= white_space_normal;
+        m_caption_side			= caption_side_top;
+        m_border_collapse		= border_collapse_separate;
+        m_css_border_spacing_x	= css_length(0);
+        m_css_border_spacing_y	= css_length(0);
+        m_cursor				= "auto";
+        m_css_text_indent		= css_length(0);
+        m_css_line_height		= css_length::predef_value(0);
+        m_list_style_type		= list_style_type_disc;
+        m_list_style_position	= list_style_position_outside;
+        m_list_style_image.clear();
+        m_list_style_image_baseurl.clear();
+        m_font_size				= css_length::predef_value(font_size_medium);
+        m_font_family			= doc->container()->get_default_font_name();
+        m_font_weight			= font_weight_normal;
+        m_font_style			= font_style_normal;
+        m_text_decoration		= "none";
+    }
+
+    const css_length _auto = css_length::predef_value(0);
+    const css_length _none = _auto;
+
+    m_el_position		= element_position_static;
+    m_display			= display_inline;
+    m_float				= float_none;
+    m_clear				= clear_none;
+    m_box_sizing		= box_sizing_content_box;
+    m_overflow			= overflow_visible;
+    m_vertical_align	= va_baseline;
+    m_z_index			= _auto;
+    m_content.clear();
+
+    m_css_width			= _auto;
+    m_css_height		= _auto;
+    m_css_min_width		= _auto;
+    m_css_min_height	= _auto;
+    m_css_max_width		= _none;
+    m_css_max_height	= _none;
+    m_css_offsets.left	= m_css_offsets.right = m_css_offsets.top = m_css_offsets.bottom = _auto;
+    m_css_margins.left	= m_css_margins.right = m_css_margins.top = m_css_margins.bottom = css_length(0);
+    m_css_padding.left	= m_css_padding.right = m_css_padding.top = m_css_padding.bottom = css_length(0);
+
+    for (css_border* b : { &m_css_borders.left, &m_css_borders.right, &m_css_borders.top, &m_css_borders.bottom })
+    {
+        b->style = border_style_none;
+        b->width = css_length(border_width_medium_value);
+    }
+    m_css_borders.radius.top_left_x = m_css_borders.radius.top_left_y = css_length(0);
+    m_css_borders.radius.top_right_x = m_css_borders.radius.top_right_y = css_length(0);
+    m_css_borders.radius.bottom_left_x = m_css_borders.radius.bottom_left_y = css_length(0);
+    m_css_borders.radius.bottom_right_x = m_css_borders.radius.bottom_right_y = css_length(0);
+
+    const css_size auto_auto(css_length::predef_value(background_size_auto), css_length::predef_value(background_size_auto));
+    m_bg.m_color		= web_color::transparent;
+    m_bg.m_position_x	= { css_length(0, css_units_percentage) };
+    m_bg.m_position_y	= { css_length(0, css_units_percentage) };
+    m_bg.m_size			= { auto_auto };
+    m_bg.m_attachment	= { background_attachment_scroll };
+    m_bg.m_repeat		= { background_repeat_repeat };
+    m_bg.m_clip			= { background_box_border };
+    m_bg.m_origin		= { background_box_padding };
+    m_bg.m_image		= { "" };
+    m_bg.m_baseurl.clear();
+
+    m_flex_grow				= 0;
+    m_flex_shrink			= 1;
+    m_flex_basis			= css_length::predef_value(flex_basis_auto);
+    m_flex_direction		= flex_direction_row;
+    m_flex_wrap				= flex_wrap_nowrap;
+    m_flex_justify_content	= flex_justify_content_flex_start;
+    m_flex_align_items		= flex_align_items_stretch;
+    m_flex_align_self		= flex_align_self_auto;
+    m_flex_align_content	= flex_align_content_stretch;
+}
+
+// Applies the declared properties in a single pass over the sorted declarations.
+void litehtml::css_properties::cascade(const style& st, const css_properties* parent)
+{
+#define CSS_PROPERTY(id, member, type, getter)	\
+    case id: apply(member, val, type, &property_value::getter, parent ? &parent->member : nullptr); break;
+
+#define CSS_ENUM(id, member)			CSS_PROPERTY(id, member, prop_type_enum_item,			get_enum_item)
+#define CSS_LENGTH(id, member)			CSS_PROPERTY(id, member, prop_type_length,				get_length)
+#define CSS_COLOR(id, member)			CSS_PROPERTY(id, member, prop_type_color,				get_color)
+#define CSS_STRING(id, member)			CSS_PROPERTY(id, member, prop_type_string,				get_string)
+#define CSS_NUMBER(id, member)			CSS_PROPERTY(id, member, prop_type_number,				get_number)
+#define CSS_STRING_VECTOR(id, member)	CSS_PROPERTY(id, member, prop_type_string_vector,		get_string_vector)
+#define CSS_INT_VECTOR(id, member)		CSS_PROPERTY(id, member, prop_type_enum_item_vector,	get_enum_item_vector)
+#define CSS_LENGTH_VECTOR(id, member)	CSS_PROPERTY(id, member, prop_type_length_vector,		get_length_vector)
+#define CSS_SIZE_VECTOR(id, member)		CSS_PROPERTY(id, member, prop_type_size_vector,		get_size_vector)
+
+// border colors default to the computed 'color', so remember which ones were set
+#define CSS_BORDER_COLOR(id, side, bit)	\
+    case id: if (apply(m_css_borders.side.color, val, prop_type_color, &property_value::get_color, parent ? &parent->m_css_borders.side.color : nullptr)) border_colors |= bit; break;
+
+    unsigned border_colors = 0;
+
+    for (const auto& item : st.properties())
+    {
+        const property_value& val = item.second;
+        switch (item.first)
+        {
+        CSS_COLOR(_color_, m_color)
+
+        CSS_ENUM(_position_,		m_el_position)
+        CSS_ENUM(_display_,			m_display)
+        CSS_ENUM(_visibility_,		m_visibility)
+        CSS_ENUM(_float_,			m_float)
+        CSS_ENUM(_clear_,			m_clear)
+        CSS_ENUM(_box_sizing_,		m_box_sizing)
+        CSS_ENUM(_overflow_,		m_overflow)
+        CSS_ENUM(_text_align_,		m_text_align)
+        CSS_ENUM(_vertical_align_,	m_vertical_align)
+        CSS_ENUM(_text_transform_,	m_text_transform)
+        CSS_ENUM(_white_space_,		m_white_space)
+        CSS_ENUM(_caption_side_,	m_caption_side)
+
+        CSS_LENGTH(_width_,			m_css_width)
+        CSS_LENGTH(_height_,		m_css_height)
+        CSS_LENGTH(_min_width_,		m_css_min_width)
+        CSS_LENGTH(_min_height_,	m_css_min_height)
+        CSS_LENGTH(_max_width_,		m_css_max_width)
+        CSS_LENGTH(_max_height_,	m_css_max_height)
+
+        CSS_LENGTH(_margin_left_,	m_css_margins.left)
+        CSS_LENGTH(_margin_right_,	m_css_margins.right)
+        CSS_LENGTH(_margin_top_,	m_css_margins.top)
+        CSS_LENGTH(_margin_bottom_,	m_css_margins.bottom)
+
+        CSS_LENGTH(_padding_left_,		m_css_padding.left)
+        CSS_LENGTH(_padding_right_,		m_css_padding.right)
+        CSS_LENGTH(_padding_top_,		m_css_padding.top)
+        CSS_LENGTH(_padding_bottom_,	m_css_padding.bottom)
+
+        CSS_BORDER_COLOR(_border_left_color_,	left,	1)
+        CSS_BORDER_COLOR(_border_right_color_,	right,	2)
+        CSS_BORDER_COLOR(_border_top_color_,	top,	4)
+        CSS_BORDER_COLOR(_border_bottom_color_,	bottom,	8)
+
+        CSS_ENUM(_border_left_style_,	m_css_borders.left.style)
+        CSS_ENUM(_border_right_style_,	m_css_borders.right.style)
+        CSS_ENUM(_border_top_style_,	m_css_borders.top.style)
+        CSS_ENUM(_border_bottom_style_,	m_css_borders.bottom.style)
+
+        CSS_LENGTH(_border_left_width_,		m_css_borders.left.width)
+        CSS_LENGTH(_border_right_width_,	m_css_borders.right.width)
+        CSS_LENGTH(_border_top_width_,		m_css_borders.top.width)
+        CSS_LENGTH(_border_bottom_width_,	m_css_borders.bottom.width)
+
+        CSS_LENGTH(_border_top_left_radius_x_,		m_css_borders.radius.top_left_x)
+        CSS_LENGTH(_border_top_left_radius_y_,		m_css_borders.radius.top_left_y)
+        CSS_LENGTH(_border_top_right_radius_x_,		m_css_borders.radius.top_right_x)
+        CSS_LENGTH(_border_top_right_radius_y_,		m_css_borders.radius.top_right_y)
+        CSS_LENGTH(_border_bottom_left_radius_x_,	m_css_borders.radius.bottom_left_x)
+        CSS_LENGTH(_border_bottom_left_radius_y_,	m_css_borders.radius.bottom_left_y)
+        CSS_LENGTH(_border_bottom_right_radius_x_,	m_css_borders.radius.bottom_right_x)
+        CSS_LENGTH(_border_bottom_right_radius_y_,	m_css_borders.radius.bottom_right_y)
+
+        CSS_ENUM(_border_collapse_,					m_border_collapse)
+        CSS_LENGTH(__litehtml_border_spacing_x_,	m_css_border_spacing_x)
+        CSS_LENGTH(__litehtml_border_spacing_y_,	m_css_border_spacing_y)
+
+        CSS_LENGTH(_left_,		m_css_offsets.left)
+        CSS_LENGTH(_right_,		m_css_offsets.right)
+        CSS_LENGTH(_top_,		m_css_offsets.top)
+        CSS_LENGTH(_bottom_,	m_css_offsets.bottom)
+
+        CSS_LENGTH(_z_index_,		m_z_index)
+        CSS_STRING(_content_,		m_content)
+        CSS_STRING(_cursor_,		m_cursor)
+        CSS_LENGTH(_text_indent_,	m_css_text_indent)
+        CSS_LENGTH(_line_height_,	m_css_line_height)
+
+        CSS_ENUM(_list_style_type_,				m_list_style_type)
+        CSS_ENUM(_list_style_position_,			m_list_style_position)
+        CSS_STRING(_list_style_image_,			m_list_style_image)
+        CSS_STRING(_list_style_image_baseurl_,	m_list_style_image_baseurl)
+
+        CSS_LENGTH(_font_size_,			m_font_size)
+        CSS_STRING(_font_family_,		m_font_family)
+        CSS_ENUM(_font_weight_,			m_font_weight)
+        CSS_ENUM(_font_style_,			m_font_style)
+        CSS_STRING(_text_decoration_,	m_text_decoration)
+
+        CSS_COLOR(_background_color_,					m_bg.m_color)
+        CSS_LENGTH_VECTOR(_background_position_x_,		m_bg.m_position_x)
+        CSS_LENGTH_VECTOR(_background_position_y_,		m_bg.m_position_y)
+        CSS_SIZE_VECTOR(_background_size_,				m_bg.m_size)
+        CSS_INT_VECTOR(_background_attachment_,			m_bg.m_attachment)
+        CSS_INT_VECTOR(_background_repeat_,				m_bg.m_repeat)
+        CSS_INT_VECTOR(_background_clip_,				m_bg.m_clip)
+        CSS_INT_VECTOR(_background_origin_,				m_bg.m_origin)
+        CSS_STRING_VECTOR(_background_image_,			m_bg.m_image)
+        CSS_STRING(_background_image_baseurl_,			m_bg.m_baseurl)
+
+        CSS_ENUM(_flex_direction_,		m_flex_direction)
+        CSS_ENUM(_flex_wrap_,			m_flex_wrap)
+        CSS_ENUM(_justify_content_,		m_flex_justify_content)
+        CSS_ENUM(_align_items_,			m_flex_align_items)
+        CSS_ENUM(_align_content_,		m_flex_align_content)
+        CSS_NUMBER(_flex_grow_,			m_flex_grow)
+        CSS_NUMBER(_flex_shrink_,		m_flex_shrink)
+        CSS_LENGTH(_flex_basis_,		m_flex_basis)
+        CSS_ENUM(_align_self_,			m_flex_align_self)
+
+        default:
+            break;
+        }
+    }
+
+    if (!(border_colors & 1)) m_css_borders.left.color		= m_color;
+    if (!(border_colors & 2)) m_css_borders.right.color		= m_color;
+    if (!(border_colors & 4)) m_css_borders.top.color		= m_color;
+    if (!(border_colors & 8)) m_css_borders.bottom.color	= m_color;
+
+#undef CSS_BORDER_COLOR
+#undef CSS_SIZE_VECTOR
+#undef CSS_LENGTH_VECTOR
+#undef CSS_INT_VECTOR
+#undef CSS_STRING_VECTOR
+#undef CSS_NUMBER
+#undef CSS_STRING
+#undef CSS_COLOR
+#undef CSS_LENGTH
+#undef CSS_ENUM
+#undef CSS_PROPERTY
 }
 
 static const int font_size_table[8][7] =
@@ -256,17 +469,16 @@ static const int font_size_table[8][7] =
         { 9,   10,    13,    16,    18,    24,    32}
 };
 
-void litehtml::css_properties::compute_font(const element* el, const document::ptr& doc)
+void litehtml::css_properties::compute_font(const css_properties* parent, const document::ptr& doc)
 {
     // initialize font size
-    css_length sz = el->get_length_property(_font_size_, true, css_length::predef_value(font_size_medium), offset(m_font_size));
 
+    const css_length sz = m_font_size;
     int parent_sz = 0;
     int doc_font_size = doc->container()->get_default_font_size();
-    element::ptr el_parent = el->parent();
-    if (el_parent)
+    if (parent)
     {
-        parent_sz = el_parent->css().get_font_size();
+        parent_sz = parent->get_font_size();
     } else
     {
         parent_sz = doc_font_size;
@@ -339,31 +551,32 @@ void litehtml::css_properties::compute_font(const element* el, const document::p
     m_font_size = (float)font_size;
 
     // initialize font
-    m_font_family		=               el->get_string_property(_font_family_,		true, doc->container()->get_default_font_name(),	offset(m_font_family));
-    m_font_weight		= (font_weight) el->get_enum_property(  _font_weight_,		true, font_weight_normal,							offset(m_font_weight));
-    m_font_style		= (font_style)  el->get_enum_property(  _font_style_,		true, font_style_normal,							offset(m_font_style));
-    m_text_decoration	=               el->get_string_property(_text_decoration_,	true, "none",										offset(m_text_decoration));
-
-    m_font = doc->get_font(
-        m_font_family.c_str(),
-        font_size,
-        index_value(m_font_weight, font_weight_strings).c_str(),
-        index_value(m_font_style, font_style_strings).c_str(),
-        m_text_decoration.c_str(),
-        &m_font_metrics);
+
+    // the same font inputs as the parent resolve to the parent's font
+    if (parent)
+    {
+        if (font_size == parent_sz && m_font_weight == parent->m_font_weight && m_font_style == parent->m_font_style &&
+            m_text_decoration == parent->m_text_decoration && m_font_family == parent->m_font_family)
+        {
+            m_font			= parent->m_font;
+            m_font_metrics	= parent->m_font_metrics;
+            return;
+        }
+    }
+
+    font_key key;
+    key.family		= _id(m_font_family);
+    key.size		= font_size;
+    key.weight		= document::font_weight_value(m_font_weight);
+    key.style		= m_font_style;
+    key.decoration	= document::font_decoration_value(m_text_decoration.c_str());
+    m_font = doc->get_font(key, &m_font_metrics);
 }
 
-void litehtml::css_properties::compute_background(const element* el, const document::ptr& doc)
+void litehtml::css_properties::compute_background(const document::ptr& doc)
 {
     int font_size = get_font_size();
 
-    m_bg.m_color		= el->get_color_property(_background_color_, false, web_color::transparent, offset(m_bg.m_color));
-
-    const css_size auto_auto(css_length::predef_value(background_size_auto), css_length::predef_value(background_size_auto));
-    m_bg.m_position_x	= el->get_length_vector_property(_background_position_x_, false, { css_length(0, css_units_percentage) }, offset(m_bg.m_position_x));
-    m_bg.m_position_y	= el->get_length_vector_property(_background_position_y_, false, { css_length(0, css_units_percentage) }, offset(m_bg.m_position_y));
-    m_bg.m_size			= el->get_size_vector_property  (_background_size_,       false, { auto_auto }, offset(m_bg.m_size));
-
     for (auto& x : m_bg.m_position_x) doc->cvt_units(x, font_size);
     for (auto& y : m_bg.m_position_y) doc->cvt_units(y, font_size);
     for (auto& size : m_bg.m_size)
@@ -372,14 +585,6 @@ void litehtml::css_properties::compute_background(const element* el, const docum
         doc->cvt_units(size.height, font_size);
     }
 
-    m_bg.m_attachment = el->get_int_vector_property(_background_attachment_, false, { background_attachment_scroll }, offset(m_bg.m_attachment));
-    m_bg.m_repeat     = el->get_int_vector_property(_background_repeat_,     false, { background_repeat_repeat },     offset(m_bg.m_repeat));
-    m_bg.m_clip       = el->get_int_vector_property(_background_clip_,       false, { background_box_border },        offset(m_bg.m_clip));
-    m_bg.m_origin     = el->get_int_vector_property(_background_origin_,     false, { background_box_padding },       offset(m_bg.m_origin));
-
-    m_bg.m_image   = el->get_string_vector_property(_background_image_,  false, {""}, offset(m_bg.m_image));
-    m_bg.m_baseurl = el->get_string_property(_background_image_baseurl_, false, "",   offset(m_bg.m_baseurl));
-
     for (const auto& image : m_bg.m_image)
     {
         if (!image.empty())
@@ -389,24 +594,26 @@ void litehtml::css_properties::compute_background(const element* el, const docum
     }
 }
 
-void litehtml::css_properties::compute_flex(const element* el, const document::ptr& doc)
+void litehtml::css_properties::compute_flex(const css_properties* parent, const document::ptr& doc)
 {
-    if (m_display == display_flex)
+    // flex container properties apply to flex containers only
+    if (m_display != display_flex)
     {
-        m_flex_direction = (flex_direction) el->get_enum_property(_flex_direction_, false, flex_direction_row, offset(m_flex_direction));
-        m_flex_wrap = (flex_wrap) el->get_enum_property(_flex_wrap_, false, flex_wrap_nowrap, offset(m_flex_wrap));
-
-        m_flex_justify_content = (flex_justify_content) el->get_enum_property(_justify_content_, false, flex_justify_content_flex_start, offset(m_flex_justify_content));
-        m_flex_align_items = (flex_align_items) el->get_enum_property(_align_items_, false, flex_align_items_stretch, offset(m_flex_align_items));
-        m_flex_align_content = (flex_align_content) el->get_enum_property(_align_content_, false, flex_align_content_stretch, offset(m_flex_align_content));
+        m_flex_direction		= flex_direction_row;
+        m_flex_wrap				= flex_wrap_nowrap;
+        m_flex_justify_content	= flex_justify_content_flex_start;
+        m_flex_align_items		= flex_align_items_stretch;
+        m_flex_align_content	= flex_align_content_stretch;
     }
-    auto parent = el->parent();
-    if (parent && parent->css().m_display == display_flex)
+    // flex item properties apply to children of flex containers only
+    if (!parent || parent->m_display != display_flex)
+    {
+        m_flex_grow			= 0;
+        m_flex_shrink		= 1;
+        m_flex_basis		= css_length::predef_value(flex_basis_auto);
+        m_flex_align_self	= flex_align_self_auto;
+    } else
     {
-        m_flex_grow = el->get_number_property(_flex_grow_, false, 0, offset(m_flex_grow));
-        m_flex_shrink = el->get_number_property(_flex_shrink_, false, 1, offset(m_flex_shrink));
-        m_flex_align_self = (flex_align_self) el->get_enum_property(_align_self_, false, flex_align_self_auto, offset(m_flex_align_self));
-        m_flex_basis = el->get_length_property(_flex_shrink_, false, css_length::predef_value(flex_basis_auto), offset(m_flex_basis));
         doc->cvt_units(m_flex_basis, get_font_size());
         if(m_display == display_inline || m_display == display_inline_block)
         {
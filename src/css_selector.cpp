@@ -312,6 +312,50 @@ void litehtml::css_selector::calc_specificity()
     }
 }
 
+void litehtml::css_selector::calc_ancestor_hashes()
+{
+	// Only the compounds on the left of descendant and child combinators are ancestors
+	// of the matched element. The hashes are capped, testing a few keys rejects most rules.
+	const size_t max_hashes = 4;
+
+	m_ancestor_hashes.clear();
+	for(const css_selector* sel = this; sel->m_left && m_ancestor_hashes.size() < max_hashes; sel = sel->m_left.get())
+	{
+		if(sel->m_combinator != combinator_descendant && sel->m_combinator != combinator_child)
+		{
+			continue;
+		}
+		const css_element_selector& ancestor = sel->m_left->m_right;
+		for(const auto& attr : ancestor.m_attrs)
+		{
+			if(attr.type == select_id)
+			{
+				m_ancestor_hashes.push_back(ancestor_filter::id_hash(attr.name));
+			} else if(attr.type == select_class)
+			{
+				m_ancestor_hashes.push_back(ancestor_filter::class_hash(attr.name));
+			}
+		}
+		if(ancestor.m_tag != star_id)
+		{
+			m_ancestor_hashes.push_back(ancestor_filter::tag_hash(ancestor.m_tag));
+		}
+	}
+	if(m_ancestor_hashes.size() > max_hashes)
+	{
+		m_ancestor_hashes.resize(max_hashes);
+	}
+}
+
+bool litehtml::css_selector::is_media_valid(const document* doc) const
+{
+    if(!m_media_query)
+    {
+        return true;
+    }
+    return doc && doc->is_media_used(m_media_query);
+}
+
 void litehtml::css_selector::add_media_to_doc( document* doc ) const
 {
     if(m_media_query && doc)
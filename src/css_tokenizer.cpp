@@ -0,0 +1,164 @@
+#include "../include/litehtml/html.h"
+#include "../include/litehtml/css_tokenizer.h"
+
+static inline bool is_css_whitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f';
+}
+
+void litehtml::css_tokenizer::skip_comment()
+{
+    m_pos += 2;
+    while(m_pos + 1 < m_end && !(m_pos[0] == '*' && m_pos[1] == '/'))
+    {
+        m_pos++;
+    }
+    m_pos = m_pos + 1 < m_end ? m_pos + 2 : m_end;
+}
+
+void litehtml::css_tokenizer::skip_string()
+{
+    char quote = *m_pos++;
+    while(m_pos < m_end && *m_pos != quote)
+    {
+        if(*m_pos == '\\' && m_pos + 1 < m_end)
+        {
+            m_pos++;
+        }
+        m_pos++;
+    }
+    if(m_pos < m_end)
+    {
+        m_pos++;
+    }
+}
+
+void litehtml::css_tokenizer::skip_parens()
+{
+    int depth = 0;
+    while(m_pos < m_end)
+    {
+        char c = *m_pos;
+        if(c == '"' || c == '\'')
+        {
+            skip_string();
+            continue;
+        }
+        if(at_comment())
+        {
+            skip_comment();
+            continue;
+        }
+        m_pos++;
+        if(c == '(')
+        {
+            depth++;
+        } else if(c == ')' && !--depth)
+        {
+            return;
+        }
+    }
+}
+
+void litehtml::css_tokenizer::skip_whitespace()
+{
+    while(m_pos < m_end)
+    {
+        if(is_css_whitespace(*m_pos))
+        {
+            m_pos++;
+        } else if(at_comment())
+        {
+            skip_comment();
+        } else
+        {
+            break;
+        }
+    }
+}
+
+bool litehtml::css_tokenizer::skip_until(const char* stops)
+{
+    while(m_pos < m_end)
+    {
+        char c = *m_pos;
+        if(c && strchr(stops, c))
+        {
+            return true;
+        }
+        if(c == '"' || c == '\'')
+        {
+            skip_string();
+        } else if(c == '(')
+        {
+            skip_parens();
+        } else if(at_comment())
+        {
+            skip_comment();
+        } else
+        {
+            m_pos++;
+        }
+    }
+    return false;
+}
+
+bool litehtml::css_tokenizer::skip_block()
+{
+    int depth = 0;
+    while(skip_until("{}"))
+    {
+        if(*m_pos == '{')
+        {
+            depth++;
+        } else if(!--depth)
+        {
+            return true;
+        }
+        m_pos++;
+    }
+    return false;
+}
+
+void litehtml::css_tokenizer::get_text(const char* begin, const char* end, string& text)
+{
+    while(begin < end && is_css_whitespace(*begin)) begin++;
+    while(end > begin && is_css_whitespace(end[-1])) end--;
+
+    css_tokenizer tok(begin, end);
+    text.clear();
+    const char* chunk = begin;
+    while(tok.skip_until("/"))
+    {
+        if(tok.at_comment())
+        {
+            text.append(chunk, tok.pos());
+            tok.skip_comment();
+            chunk = tok.pos();
+        } else
+        {
+            tok.next();
+        }
+    }
+    if(chunk == begin)
+    {
+        text.assign(begin, end);
+    } else
+    {
+        text.append(chunk, end);
+        trim(text);
+    }
+}
+
+const char* litehtml::css_tokenizer::find_last(const char* begin, const char* end, char chr)
+{
+    const char stops[] = {chr, 0};
+    const char* ret = end;
+    css_tokenizer tok(begin, end);
+    while(tok.skip_until(stops))
+    {
+        ret = tok.pos();
+        tok.next();
+    }
+    return ret;
+}
@@ -1,44 +1,123 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/document_container.h"
 
-void litehtml::document_container::split_text(const char* text, const std::function<void(const char*)>& on_word, const std::function<void(const char*)>& on_space)
+namespace
 {
-    std::wstring str;
-    std::wstring str_in = (const wchar_t*)utf8_to_wchar(text);
-    ucode_t c;
-    for (size_t i = 0; i < str_in.length(); i++)
+    // true if any of the 8 bytes is <= ' ' (space or control char, including NUL)
+    // or >= 0x80 (part of a multibyte UTF-8 sequence)
+    inline bool has_special_byte(uint64_t v)
     {
-        c = (ucode_t)str_in[i];
-        if (c <= ' ' && (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'))
+        const uint64_t ones = 0x0101010101010101ull;
+        const uint64_t high = 0x8080808080808080ull;
+        return ((v - ones * 0x21) | v) & high;
+    }
+
+    inline bool is_space_char(unsigned char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+    }
+
+    // Decodes the UTF-8 sequence at str. Returns the length of the sequence in bytes; a
+    // sequence truncated by the end of the string or a bad lead byte counts as one byte.
+    inline size_t decode_utf8(const unsigned char* str, litehtml::ucode_t& c)
+    {
+        size_t len;
+        unsigned char b1 = str[0];
+        if((b1 & 0xe0) == 0xc0)
+        {
+            len = 2;
+            c = b1 & 0x1f;
+        } else if((b1 & 0xf0) == 0xe0)
+        {
+            len = 3;
+            c = b1 & 0x0f;
+        } else if((b1 & 0xf8) == 0xf0)
         {
-            if (!str.empty())
+            len = 4;
+            c = b1 & 0x07;
+        } else
+        {
+            c = b1;
+            return 1;
+        }
+        for(size_t i = 1; i < len; i++)
+        {
+            if(!str[i])
             {
-                on_word(wchar_to_utf8(str.c_str()));
-                str.clear();
+                c = b1;
+                return 1;
             }
-            str += c;
-            on_space(wchar_to_utf8(str.c_str()));
-            str.clear();
+            c = (c << 6) | (str[i] & 0x3f);
         }
-        // CJK character range
-        else if (c >= 0x4E00 && c <= 0x9FCC)
+        return len;
+    }
+}
+
+litehtml::document_container::~document_container()
+{
+    css::clear_cache(this);
+}
+
+void litehtml::document_container::split_text(const char* text, const std::function<void(const char*, size_t)>& on_word, const std::function<void(const char*, size_t)>& on_space)
+{
+    if(!text) return;
+
+    const unsigned char* p = (const unsigned char*) text;
+    const unsigned char* end = p + strlen(text);
+    const unsigned char* word = p;
+
+    while(true)
+    {
+        // fast path: skip runs of printable ASCII 8 bytes at a time
+        uint64_t v;
+        while((size_t) (end - p) >= sizeof(v) && (memcpy(&v, p, sizeof(v)), !has_special_byte(v)))
+        {
+            p += sizeof(v);
+        }
+        while(*p > ' ' && *p < 0x80) p++;
+
+        if(p == end) break;
+
+        if(*p < 0x80)
         {
-            if (!str.empty())
+            if(is_space_char(*p))
+            {
+                if(p != word)
+                {
+                    on_word((const char*) word, p - word);
+                }
+                // runs of spaces and tabs are passed as one space, line breaks separately
+                size_t len = 1;
+                if(*p == ' ' || *p == '\t')
+                {
+                    while(p[len] == ' ' || p[len] == '\t') len++;
+                }
+                on_space((const char*) p, len);
+                p += len;
+                word = p;
+            } else
             {
-                on_word(wchar_to_utf8(str.c_str()));
-                str.clear();
+                p++;
             }
-            str += c;
-            on_word(wchar_to_utf8(str.c_str()));
-            str.clear();
-        }
-        else
+        } else
         {
-            str += c;
+            ucode_t c;
+            size_t len = decode_utf8(p, c);
+            // CJK character range
+            if(c >= 0x4E00 && c <= 0x9FCC)
+            {
+                if(p != word)
+                {
+                    on_word((const char*) word, p - word);
+                }
+                on_word((const char*) p, len);
+                word = p + len;
+            }
+            p += len;
         }
     }
-    if (!str.empty())
+    if(p != word)
     {
-        on_word(wchar_to_utf8(str.c_str()));
+        on_word((const char*) word, p - word);
     }
 }
@@ -29,10 +29,65 @@
 #include "../include/litehtml/render_item.h"
 #include "../include/litehtml/render_table.h"
 #include "../include/litehtml/render_block.h"
+#include "../include/litehtml/keywords.h"
+
+namespace
+{
+    // Gumbo allocator hooks: the parse tree is bump-allocated from a monotonic_arena
+    // and released in one shot with the arena instead of node by node.
+    void* gumbo_arena_allocate(void* userdata, size_t size)
+    {
+        return static_cast<litehtml::monotonic_arena*>(userdata)->allocate(size, alignof(std::max_align_t));
+    }
+
+    void gumbo_arena_deallocate(void* /*userdata*/, void* /*ptr*/)
+    {
+    }
+
+    GumboOutput* gumbo_parse_in_arena(const char* str, size_t len, litehtml::monotonic_arena& arena)
+    {
+        GumboOptions options = kGumboDefaultOptions;
+        options.allocator	= gumbo_arena_allocate;
+        options.deallocator	= gumbo_arena_deallocate;
+        options.userdata	= &arena;
+        return gumbo_parse_with_options(&options, str, len);
+    }
+
+    // the parse tree is a few times larger than the source, start with blocks of about that size
+    size_t gumbo_arena_block_size(size_t len)
+    {
+        return std::max<size_t>(len * 2, 64 * 1024);
+    }
+}
 
 litehtml::document::document(document_container* objContainer)
 {
     m_container	= objContainer;
+    m_master_css	= use_stylesheet(nullptr);
+    m_user_css		= use_stylesheet(nullptr);
+}
+
+litehtml::tstring_view litehtml::document::store_text(const char* text, size_t len)
+{
+    if(!m_arena)
+    {
+        return {};
+    }
+    // single ASCII characters (mostly spaces and punctuation) don't need a copy
+    static const char single_chars[128][2] = {
+        #define SC(c) {c, 0}, {c + 1, 0}, {c + 2, 0}, {c + 3, 0}, {c + 4, 0}, {c + 5, 0}, {c + 6, 0}, {c + 7, 0}
+        SC(0), SC(8), SC(16), SC(24), SC(32), SC(40), SC(48), SC(56),
+        SC(64), SC(72), SC(80), SC(88), SC(96), SC(104), SC(112), SC(120)
+        #undef SC
+    };
+    if(len == 1 && (unsigned char) text[0] < 128)
+    {
+        return tstring_view(single_chars[(unsigned char) text[0]], 1);
+    }
+    char* buf = static_cast<char*>(m_arena->allocate(len + 1, 1));
+    memcpy(buf, text, len);
+    buf[len] = 0;
+    return tstring_view(buf, len);
 }
 
 litehtml::document::~document()
@@ -47,13 +102,19 @@ litehtml::document::~document()
     }
 }
 
-litehtml::document::ptr litehtml::document::createFromString( const char* str, document_container* objPainter, const char* master_styles, const char* user_styles )
+litehtml::document::ptr litehtml::document::createFromString( const char* str, document_container* objPainter, const char* master_styles, const char* user_styles, bool use_arena )
 {
     // parse document into GumboOutput
-    GumboOutput* output = gumbo_parse(str);
+    size_t len = strlen(str);
+    monotonic_arena gumbo_arena(gumbo_arena_block_size(len));
+    GumboOutput* output = gumbo_parse_in_arena(str, len, gumbo_arena);
 
     // Create litehtml::document
     document::ptr doc = std::make_shared<document>(objPainter);
+    if (use_arena)
+    {
+        doc->m_arena = std::make_shared<monotonic_arena>();
+    }
 
     // Create litehtml::elements.
     elements_list root_elements;
@@ -63,18 +124,17 @@ litehtml::document::ptr litehtml::document::createFromString( const char* str, d
         doc->m_root = root_elements.back();
     }
     // Destroy GumboOutput
-    gumbo_destroy_output(&kGumboDefaultOptions, output);
+    gumbo_arena.release();
 
-    if (master_styles && *master_styles)
+    if (master_styles && (master_styles == litehtml::master_css || !strcmp(master_styles, litehtml::master_css)))
     {
-        doc->m_master_css.parse_stylesheet(master_styles, nullptr, doc, nullptr);
-        doc->m_master_css.sort_selectors();
+        doc->m_master_css = css::default_master();
     }
-    if (user_styles && *user_styles)
+    else
     {
-        doc->m_user_css.parse_stylesheet(user_styles, nullptr, doc, nullptr);
-        doc->m_user_css.sort_selectors();
+        doc->m_master_css = doc->use_stylesheet(master_styles);
     }
+    doc->m_user_css = doc->use_stylesheet(user_styles);
 
     // Let's process created elements tree
     if (doc->m_root)
@@ -84,24 +144,15 @@ litehtml::document::ptr litehtml::document::createFromString( const char* str, d
         doc->m_root->set_pseudo_class(_root_, true);
 
         // apply master CSS
-        doc->m_root->apply_stylesheet(doc->m_master_css);
+        doc->m_root->apply_stylesheet(*doc->m_master_css);
 
         // parse elements attributes
         doc->m_root->parse_attributes();
 
         // parse style sheets linked in document
-        media_query_list::ptr media;
         for (const auto& css : doc->m_css)
         {
-            if (!css.media.empty())
-            {
-                media = media_query_list::create_from_string(css.media, doc);
-            }
-            else
-            {
-                media = nullptr;
-            }
-            doc->m_styles.parse_stylesheet(css.text.c_str(), css.baseurl.c_str(), doc, media);
+            doc->m_styles.add_selectors(*doc->use_stylesheet(css.text.c_str(), css.baseurl.c_str(), css.media.c_str()));
         }
         // Sort css selectors using CSS rules.
         doc->m_styles.sort_selectors();
@@ -116,7 +167,7 @@ litehtml::document::ptr litehtml::document::createFromString( const char* str, d
         doc->m_root->apply_stylesheet(doc->m_styles);
 
         // Apply user styles if any
-        doc->m_root->apply_stylesheet(doc->m_user_css);
+        doc->m_root->apply_stylesheet(*doc->m_user_css);
 
         // Initialize m_css
         doc->m_root->compute_styles();
@@ -137,117 +188,47 @@ litehtml::document::ptr litehtml::document::createFromString( const char* str, d
     return doc;
 }
 
-litehtml::uint_ptr litehtml::document::add_font( const char* name, int size, const char* weight, const char* style, const char* decoration, font_metrics* fm )
+int litehtml::document::font_weight_value(font_weight weight)
 {
-    uint_ptr ret = 0;
-
-    if(!name)
+    switch(weight)
     {
-        name = m_container->get_default_font_name();
+    case font_weight_bold:		return 700;
+    case font_weight_bolder:	return 600;
+    case font_weight_lighter:	return 300;
+    case font_weight_100:		return 100;
+    case font_weight_200:		return 200;
+    case font_weight_300:		return 300;
+    case font_weight_500:		return 500;
+    case font_weight_600:		return 600;
+    case font_weight_700:		return 700;
+    case font_weight_800:		return 800;
+    case font_weight_900:		return 900;
+    default:					return 400;
     }
+}
 
-    char strSize[20];
-    t_itoa(size, strSize, 20, 10);
-
-    string key = name;
-    key += ":";
-    key += strSize;
-    key += ":";
-    key += weight;
-    key += ":";
-    key += style;
-    key += ":";
-    key += decoration;
-
-    if(m_fonts.find(key) == m_fonts.end())
+unsigned litehtml::document::font_decoration_value(const char* decoration)
+{
+    unsigned decor = font_decoration_none;
+    for(const char* p = decoration; p && *p; )
     {
-        font_style fs = (font_style) value_index(style, font_style_strings, font_style_normal);
-        int	fw = value_index(weight, font_weight_strings, -1);
-        if(fw >= 0)
+        while(*p == ' ') p++;
+        const char* end = p;
+        while(*end && *end != ' ') end++;
+        size_t len = end - p;
+        if(len == 9 && !t_strncasecmp(p, "underline", len))
         {
-            switch(fw)
-            {
-            case litehtml::font_weight_bold:
-                fw = 700;
-                break;
-            case litehtml::font_weight_bolder:
-                fw = 600;
-                break;
-            case litehtml::font_weight_lighter:
-                fw = 300;
-                break;
-            case litehtml::font_weight_normal:
-                fw = 400;
-                break;
-            case litehtml::font_weight_100:
-                fw = 100;
-                break;
-            case litehtml::font_weight_200:
-                fw = 200;
-                break;
-            case litehtml::font_weight_300:
-                fw = 300;
-                break;
-            case litehtml::font_weight_400:
-                fw = 400;
-                break;
-            case litehtml::font_weight_500:
-                fw = 500;
-                break;
-            case litehtml::font_weight_600:
-                fw = 600;
-                break;
-            case litehtml::font_weight_700:
-                fw = 700;
-                break;
-            case litehtml::font_weight_800:
-                fw = 800;
-                break;
-            case litehtml::font_weight_900:
-                fw = 900;
-                break;
-            }
-        } else
-        {
-            fw = atoi(weight);
-            if(fw < 100)
-            {
-                fw = 400;
-            }
-        }
-
-        unsigned int decor = 0;
-
-        if(decoration)
+            decor |= font_decoration_underline;
+        } else if(len == 12 && !t_strncasecmp(p, "line-through", len))
         {
-            std::vector<string> tokens;
-            split_string(decoration, tokens, " ");
-            for(auto & token : tokens)
-            {
-                if(!t_strcasecmp(token.c_str(), "underline"))
-                {
-                    decor |= font_decoration_underline;
-                } else if(!t_strcasecmp(token.c_str(), "line-through"))
-                {
-                    decor |= font_decoration_linethrough;
-                } else if(!t_strcasecmp(token.c_str(), "overline"))
-                {
-                    decor |= font_decoration_overline;
-                }
-            }
-        }
-
-        font_item fi {};
-
-        fi.font = m_container->create_font(name, size, fw, fs, decor, &fi.metrics);
-        m_fonts[key] = fi;
-        ret = fi.font;
-        if(fm)
+            decor |= font_decoration_linethrough;
+        } else if(len == 8 && !t_strncasecmp(p, "overline", len))
         {
-            *fm = fi.metrics;
+            decor |= font_decoration_overline;
         }
+        p = end;
     }
-    return ret;
+    return decor;
 }
 
 litehtml::uint_ptr litehtml::document::get_font( const char* name, int size, const char* weight, const char* style, const char* decoration, font_metrics* fm )
@@ -261,33 +242,106 @@ litehtml::uint_ptr litehtml::document::get_font( const char* name, int size, con
         name = m_container->get_default_font_name();
     }
 
-    char strSize[20];
-    t_itoa(size, strSize, 20, 10);
-
-    string key = name;
-    key += ":";
-    key += strSize;
-    key += ":";
-    key += weight;
-    key += ":";
-    key += style;
-    key += ":";
-    key += decoration;
+    font_key key;
+    key.family		= _id(name);
+    key.size		= size;
+    key.style		= (font_style) font_style_keywords().find(style, font_style_normal);
+    key.decoration	= font_decoration_value(decoration);
 
-    auto el = m_fonts.find(key);
-
-    if(el != m_fonts.end())
+    int	fw = font_weight_keywords().find(weight, -1);
+    if(fw >= 0)
     {
-        if(fm)
+        key.weight = font_weight_value((font_weight) fw);
+    } else
+    {
+        key.weight = atoi(weight);
+        if(key.weight < 100)
         {
-            *fm = el->second.metrics;
+            key.weight = 400;
         }
-        return el->second.font;
     }
-    return add_font(name, size, weight, style, decoration, fm);
+    return get_font(key, fm);
+}
+
+litehtml::uint_ptr litehtml::document::get_font( const font_key& key, font_metrics* fm )
+{
+    if(!key.size)
+    {
+        return 0;
+    }
+
+    auto el = m_fonts.find(key);
+    if(el == m_fonts.end())
+    {
+        font_item fi {};
+        fi.font = m_container->create_font(_s(key.family).c_str(), key.size, key.weight, key.style, key.decoration, &fi.metrics);
+        el = m_fonts.emplace(key, fi).first;
+    }
+    if(fm)
+    {
+        *fm = el->second.metrics;
+    }
+    return el->second.font;
 }
 
 int litehtml::document::render( int max_width, render_type rt )
+{
+    m_layout_bottom = -1;
+    return start_layout(max_width, rt);
+}
+
+int litehtml::document::render( int max_width, const position& viewport, render_type rt )
+{
+    m_layout_bottom = std::max(viewport.bottom(), 0) + viewport.height;
+    m_layout_overscan = viewport.height;
+    return start_layout(max_width, rt);
+}
+
+int litehtml::document::render_changes( int max_width, render_type rt )
+{
+    if(max_width != m_rendered_width)
+    {
+        return start_layout(max_width, rt);
+    }
+    // the layout caches of the items that need layout are dropped, the rest returns at once
+    return layout(max_width, rt);
+}
+
+int litehtml::document::start_layout( int max_width, render_type rt )
+{
+    m_layout_generation++;
+    m_pending_layout.clear();
+    return layout(max_width, rt);
+}
+
+void litehtml::document::layout_to( int bottom )
+{
+    if(m_layout_bottom < 0 || (bottom >= 0 && bottom <= m_layout_bottom))
+    {
+        return;
+    }
+    if(bottom < 0 || bottom >= m_size.height)
+    {
+        m_layout_bottom = -1;
+    } else
+    {
+        // growing the region at least twice keeps the total layout work linear in the document length
+        m_layout_bottom = std::max(bottom + m_layout_overscan, m_layout_bottom * 2);
+    }
+    if(m_pending_layout.empty())
+    {
+        return;
+    }
+    // the blocks skip their children again if they are still below the bottom
+    for(const auto& ri : m_pending_layout)
+    {
+        ri->set_needs_layout();
+    }
+    m_pending_layout.clear();
+    layout(m_rendered_width, render_all);
+}
+
+int litehtml::document::layout( int max_width, render_type rt )
 {
     int ret = 0;
     if(m_root)
@@ -317,6 +371,8 @@ int litehtml::document::render( int max_width, render_type rt )
             m_content_size.width = 0;
             m_content_size.height = 0;
             m_root_render->calc_document_size(m_size, m_content_size);
+            m_root_render->clear_needs_layout();
+            m_rendered_width = max_width;
         }
     }
     return ret;
@@ -326,6 +382,7 @@ void litehtml::document::draw( uint_ptr hdc, int x, int y, const position* clip
 {
     if(m_root && m_root_render)
     {
+        layout_to(clip ? std::max(clip->bottom() - y, 0) : -1);
         m_root->draw(hdc, x, y, clip, m_root_render);
         m_root_render->draw_stacking_context(hdc, x, y, clip, true);
     }
@@ -462,6 +519,7 @@ bool litehtml::document::on_mouse_over( int x, int y, int client_x, int client_y
         return false;
     }
 
+    layout_to(y + 1);
     element::ptr over_el = m_root_render->get_element_by_point(x, y, client_x, client_y);
 
     bool state_was_changed = false;
@@ -521,6 +579,7 @@ bool litehtml::document::on_lbutton_down( int x, int y, int client_x, int client
         return false;
     }
 
+    layout_to(y + 1);
     element::ptr over_el = m_root_render->get_element_by_point(x, y, client_x, client_y);
 
     bool state_was_changed = false;
@@ -593,52 +652,52 @@ litehtml::element::ptr litehtml::document::create_element(const char* tag_name,
     {
         if(!strcmp(tag_name, "br"))
         {
-            newTag = std::make_shared<litehtml::el_break>(this_doc);
+            newTag = make_node<litehtml::el_break>(this_doc);
         } else if(!strcmp(tag_name, "p"))
         {
-            newTag = std::make_shared<litehtml::el_para>(this_doc);
+            newTag = make_node<litehtml::el_para>(this_doc);
         } else if(!strcmp(tag_name, "img"))
         {
-            newTag = std::make_shared<litehtml::el_image>(this_doc);
+            newTag = make_node<litehtml::el_image>(this_doc);
         } else if(!strcmp(tag_name, "table"))
         {
-            newTag = std::make_shared<litehtml::el_table>(this_doc);
+            newTag = make_node<litehtml::el_table>(this_doc);
         } else if(!strcmp(tag_name, "td") || !strcmp(tag_name, "th"))
         {
-            newTag = std::make_shared<litehtml::el_td>(this_doc);
+            newTag = make_node<litehtml::el_td>(this_doc);
         } else if(!strcmp(tag_name, "link"))
         {
-            newTag = std::make_shared<litehtml::el_link>(this_doc);
+            newTag = make_node<litehtml::el_link>(this_doc);
         } else if(!strcmp(tag_name, "title"))
         {
-            newTag = std::make_shared<litehtml::el_title>(this_doc);
+            newTag = make_node<litehtml::el_title>(this_doc);
         } else if(!strcmp(tag_name, "a"))
         {
-            newTag = std::make_shared<litehtml::el_anchor>(this_doc);
+            newTag = make_node<litehtml::el_anchor>(this_doc);
         } else if(!strcmp(tag_name, "tr"))
         {
-            newTag = std::make_shared<litehtml::el_tr>(this_doc);
+            newTag = make_node<litehtml::el_tr>(this_doc);
         } else if(!strcmp(tag_name, "style"))
         {
-            newTag = std::make_shared<litehtml::el_style>(this_doc);
+            newTag = make_node<litehtml::el_style>(this_doc);
         } else if(!strcmp(tag_name, "base"))
         {
-            newTag = std::make_shared<litehtml::el_base>(this_doc);
+            newTag = make_node<litehtml::el_base>(this_doc);
         } else if(!strcmp(tag_name, "body"))
         {
-            newTag = std::make_shared<litehtml::el_body>(this_doc);
+            newTag = make_node<litehtml::el_body>(this_doc);
         } else if(!strcmp(tag_name, "div"))
         {
-            newTag = std::make_shared<litehtml::el_div>(this_doc);
+            newTag = make_node<litehtml::el_div>(this_doc);
         } else if(!strcmp(tag_name, "script"))
         {
-            newTag = std::make_shared<litehtml::el_script>(this_doc);
+            newTag = make_node<litehtml::el_script>(this_doc);
         } else if(!strcmp(tag_name, "font"))
         {
-            newTag = std::make_shared<litehtml::el_font>(this_doc);
+            newTag = make_node<litehtml::el_font>(this_doc);
         } else
         {
-            newTag = std::make_shared<litehtml::html_tag>(this_doc);
+            newTag = make_node<litehtml::html_tag>(this_doc);
         }
     }
 
@@ -671,6 +730,7 @@ bool litehtml::document::media_changed()
     {
         m_root->refresh_styles();
         m_root->compute_styles();
+        m_root->set_needs_layout();
         return true;
     }
     return false;
@@ -692,6 +752,7 @@ bool litehtml::document::lang_changed()
         }
         m_root->refresh_styles();
         m_root->compute_styles();
+        m_root->set_needs_layout();
         return true;
     }
     return false;
@@ -702,8 +763,11 @@ bool litehtml::document::update_media_lists(const media_features& features)
     bool update_styles = false;
     for(auto & m_media_list : m_media_lists)
     {
-        if(m_media_list->apply_media_features(features))
+        bool used = m_media_list->check(features);
+        bool& state = m_media_used[m_media_list.get()];
+        if(state != used)
         {
+            state = used;
             update_styles = true;
         }
     }
@@ -714,13 +778,34 @@ void litehtml::document::add_media_list( const media_query_list::ptr& list )
 {
     if(list)
     {
-        if(std::find(m_media_lists.begin(), m_media_lists.end(), list) == m_media_lists.end())
+        if(m_media_used.emplace(list.get(), false).second)
         {
             m_media_lists.push_back(list);
         }
     }
 }
 
+bool litehtml::document::is_media_used(const media_query_list::ptr& list) const
+{
+    auto iter = m_media_used.find(list.get());
+    return iter != m_media_used.end() && iter->second;
+}
+
+litehtml::css::const_ptr litehtml::document::use_stylesheet(const char* str, const char* baseurl, const char* media)
+{
+    if (!str || !*str)
+    {
+        static const css::const_ptr empty = std::make_shared<css>();
+        return empty;
+    }
+    css::const_ptr sheet = css::get_cached(str, baseurl, media, shared_from_this());
+    for (const auto& sel : sheet->selectors())
+    {
+        sel->add_media_to_doc(this);
+    }
+    return sheet;
+}
+
 void litehtml::document::create_node(void* gnode, elements_list& elements, bool parseTextNode)
 {
     auto* node = (GumboNode*)gnode;
@@ -779,36 +864,43 @@ void litehtml::document::create_node(void* gnode, elements_list& elements, bool
         {
             if (!parseTextNode)
             {
-                elements.push_back(std::make_shared<el_text>(node->v.text.text, shared_from_this()));
+                elements.push_back(make_node<el_text>(node->v.text.text, shared_from_this()));
             }
             else
             {
                 m_container->split_text(node->v.text.text,
-                    [this, &elements](const char* text) { elements.push_back(std::make_shared<el_text>(text, shared_from_this())); },
-                    [this, &elements](const char* text) { elements.push_back(std::make_shared<el_space>(text, shared_from_this())); });
+                    [this, &elements](const char* text, size_t len) { elements.push_back(make_node<el_text>(tstring_view(text, len), shared_from_this())); },
+                    [this, &elements](const char* text, size_t len) { elements.push_back(make_node<el_space>(tstring_view(text, len), shared_from_this())); });
             }
         }
         break;
     case GUMBO_NODE_CDATA:
         {
-            element::ptr ret = std::make_shared<el_cdata>(shared_from_this());
+            element::ptr ret = make_node<el_cdata>(shared_from_this());
             ret->set_data(node->v.text.text);
             elements.push_back(ret);
         }
         break;
     case GUMBO_NODE_COMMENT:
         {
-            element::ptr ret = std::make_shared<el_comment>(shared_from_this());
+            element::ptr ret = make_node<el_comment>(shared_from_this());
             ret->set_data(node->v.text.text);
             elements.push_back(ret);
         }
         break;
     case GUMBO_NODE_WHITESPACE:
         {
-            string str = node->v.text.text;
-            for (size_t i = 0; i < str.length(); i++)
+            // runs of spaces and tabs become one element, line breaks stay separate
+            const char* str = node->v.text.text;
+            while (*str)
             {
-                elements.push_back(std::make_shared<el_space>(str.substr(i, 1).c_str(), shared_from_this()));
+                size_t len = 1;
+                if (*str == ' ' || *str == '\t')
+                {
+                    while (str[len] == ' ' || str[len] == '\t') len++;
+                }
+                elements.push_back(make_node<el_space>(tstring_view(str, len), shared_from_this()));
+                str += len;
             }
         }
         break;
@@ -865,18 +957,18 @@ void litehtml::document::fix_table_children(const std::shared_ptr<render_item>&
 
     auto flush_elements = [&]()
     {
-        element::ptr annon_tag = std::make_shared<html_tag>(el_ptr->src_el(), string("display:") + disp_str);
+        element::ptr annon_tag = make_node<html_tag>(el_ptr->src_el(), string("display:") + disp_str);
         std::shared_ptr<render_item> annon_ri;
         if(annon_tag->css().get_display() == display_table_cell)
         {
             annon_tag->set_tagName("table_cell");
-            annon_ri = std::make_shared<render_item_block>(annon_tag);
+            annon_ri = make_node<render_item_block>(annon_tag);
         } else if(annon_tag->css().get_display() == display_table_row)
         {
-            annon_ri = std::make_shared<render_item_table_row>(annon_tag);
+            annon_ri = make_node<render_item_table_row>(annon_tag);
         } else
         {
-            annon_ri = std::make_shared<render_item_table_part>(annon_tag);
+            annon_ri = make_node<render_item_table_part>(annon_tag);
         }
         for(const auto& el : tmp)
         {
@@ -983,17 +1075,17 @@ void litehtml::document::fix_table_parent(const std::shared_ptr<render_item>& el
             }
 
             // extract elements with the same display and wrap them with anonymous object
-            element::ptr annon_tag = std::make_shared<html_tag>(parent->src_el(), string("display:") + disp_str);
+            element::ptr annon_tag = make_node<html_tag>(parent->src_el(), string("display:") + disp_str);
             std::shared_ptr<render_item> annon_ri;
             if(annon_tag->css().get_display() == display_table || annon_tag->css().get_display() == display_inline_table)
             {
-                annon_ri = std::make_shared<render_item_table>(annon_tag);
+                annon_ri = make_node<render_item_table>(annon_tag);
             } else if(annon_tag->css().get_display() == display_table_row)
             {
-                annon_ri = std::make_shared<render_item_table_row>(annon_tag);
+                annon_ri = make_node<render_item_table_row>(annon_tag);
             } else
             {
-                annon_ri = std::make_shared<render_item_table_part>(annon_tag);
+                annon_ri = make_node<render_item_table_part>(annon_tag);
             }
             std::for_each(first, std::next(last, 1),
                 [&annon_ri](std::shared_ptr<render_item>& el)
@@ -1018,14 +1110,16 @@ void litehtml::document::append_children_from_string(element& parent, const char
     }
 
     // parse document into GumboOutput
-    GumboOutput* output = gumbo_parse(str);
+    size_t len = strlen(str);
+    monotonic_arena gumbo_arena(gumbo_arena_block_size(len));
+    GumboOutput* output = gumbo_parse_in_arena(str, len, gumbo_arena);
 
     // Create litehtml::elements.
     elements_list child_elements;
     create_node(output->root, child_elements, true);
 
     // Destroy GumboOutput
-    gumbo_destroy_output(&kGumboDefaultOptions, output);
+    gumbo_arena.release();
 
     // Let's process created elements tree
     for (const auto& child : child_elements)
@@ -1034,7 +1128,7 @@ void litehtml::document::append_children_from_string(element& parent, const char
         parent.appendChild(child);
 
         // apply master CSS
-        child->apply_stylesheet(m_master_css);
+        child->apply_stylesheet(*m_master_css);
 
         // parse elements attributes
         child->parse_attributes();
@@ -1043,7 +1137,7 @@ void litehtml::document::append_children_from_string(element& parent, const char
         child->apply_stylesheet(m_styles);
 
         // Apply user styles if any
-        child->apply_stylesheet(m_user_css);
+        child->apply_stylesheet(*m_user_css);
 
         // Initialize m_css
         child->compute_styles();
@@ -1056,6 +1150,7 @@ void litehtml::document::append_children_from_string(element& parent, const char
         // Finally initialize elements
         //child->init();
     }
+    parent.set_needs_layout();
 }
 
 void litehtml::document::dump(dumper& cout)
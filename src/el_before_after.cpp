@@ -4,6 +4,7 @@
 #include "../include/litehtml/el_space.h"
 #include "../include/litehtml/el_image.h"
 #include "../include/litehtml/utf8_strings.h"
+#include "../include/litehtml/keywords.h"
 
 litehtml::el_before_after_base::el_before_after_base(const std::shared_ptr<document>& doc, bool before) : html_tag(doc)
 {
@@ -18,53 +19,54 @@ void litehtml::el_before_after_base::add_style(const style& style)
     m_children.clear();
 
     const auto& content_property = style.get_property(_content_);
-    if(content_property.m_type == prop_type_string && !content_property.m_string.empty())
+    if(content_property.m_type == prop_type_string)
     {
-        int idx = value_index(content_property.m_string, content_property_string);
-        if(idx < 0)
+        const string& content = content_property.get_string();
+        // the keywords generate no text
+        if(!content.empty() && content_property_keywords().find(content) < 0)
         {
             string fnc;
             string::size_type i = 0;
-            while(i < content_property.m_string.length() && i != string::npos)
+            while(i < content.length() && i != string::npos)
             {
-                if(content_property.m_string.at(i) == '"' || content_property.m_string.at(i) == '\'')
+                if(content.at(i) == '"' || content.at(i) == '\'')
                 {
-                    auto chr = content_property.m_string.at(i);
+                    auto chr = content.at(i);
                     fnc.clear();
                     i++;
-                    string::size_type pos = content_property.m_string.find(chr, i);
+                    string::size_type pos = content.find(chr, i);
                     string txt;
                     if(pos == string::npos)
                     {
-                        txt = content_property.m_string.substr(i);
+                        txt = content.substr(i);
                         i = string::npos;
                     } else
                     {
-                        txt = content_property.m_string.substr(i, pos - i);
+                        txt = content.substr(i, pos - i);
                         i = pos + 1;
                     }
                     add_text(txt);
-                } else if(content_property.m_string.at(i) == '(')
+                } else if(content.at(i) == '(')
                 {
                     i++;
                     litehtml::trim(fnc);
                     litehtml::lcase(fnc);
-                    string::size_type pos = content_property.m_string.find(')', i);
+                    string::size_type pos = content.find(')', i);
                     string params;
                     if(pos == string::npos)
                     {
-                        params = content_property.m_string.substr(i);
+                        params = content.substr(i);
                         i = string::npos;
                     } else
                     {
-                        params = content_property.m_string.substr(i, pos - i);
+                        params = content.substr(i, pos - i);
                         i = pos + 1;
                     }
                     add_function(fnc, params);
                     fnc.clear();
                 } else
                 {
-                    fnc += content_property.m_string.at(i);
+                    fnc += content.at(i);
                     i++;
                 }
             }
@@ -80,13 +82,33 @@ void litehtml::el_before_after_base::add_style(const style& style)
 void litehtml::el_before_after_base::add_text( const string& txt )
 {
     string word;
+    string spaces;
     string esc;
 
+    // runs of spaces and tabs become one el_space, as in document::create_node()
+    auto flush_word = [&]()
+        {
+            if(!word.empty())
+            {
+                appendChild(get_document()->make_node<el_text>(word.c_str(), get_document()));
+                word.clear();
+            }
+        };
+    auto flush_spaces = [&]()
+        {
+            if(!spaces.empty())
+            {
+                appendChild(get_document()->make_node<el_space>(spaces.c_str(), get_document()));
+                spaces.clear();
+            }
+        };
+
     for(auto chr : txt)
     {
         if(chr == '\\' ||
             (!esc.empty() && esc.length() < 5 && ((chr >= '0' && chr <= '9') || (chr >= 'A' && chr <= 'Z') || (chr >= 'a' && chr <= 'z'))))
         {
+            flush_spaces();
             if(!esc.empty() && chr == '\\')
             {
                 word += convert_escape(esc.c_str() + 1);
@@ -100,20 +122,19 @@ void litehtml::el_before_after_base::add_text( const string& txt )
                 word += convert_escape(esc.c_str() + 1);
                 esc.clear();
             }
-            if(isspace(chr))
+            if(chr == ' ' || chr == '\t')
             {
-                if(!word.empty())
-                {
-                    element::ptr el = std::make_shared<el_text>(word.c_str(), get_document());
-                    appendChild(el);
-                    word.clear();
-                }
-                word += chr;
-                element::ptr el = std::make_shared<el_space>(word.c_str(), get_document());
-                appendChild(el);
-                word.clear();
+                flush_word();
+                spaces += chr;
+            } else if(isspace(chr))
+            {
+                flush_word();
+                flush_spaces();
+                spaces += chr;
+                flush_spaces();
             } else
             {
+                flush_spaces();
                 word += chr;
             }
         }
@@ -123,12 +144,8 @@ void litehtml::el_before_after_base::add_text( const string& txt )
     {
         word += convert_escape(esc.c_str() + 1);
     }
-    if(!word.empty())
-    {
-        element::ptr el = std::make_shared<el_text>(word.c_str(), get_document());
-        appendChild(el);
-        word.clear();
-    }
+    flush_spaces();
+    flush_word();
 }
 
 void litehtml::el_before_after_base::add_function( const string& fnc, const string& params )
@@ -177,7 +194,7 @@ void litehtml::el_before_after_base::add_function( const string& fnc, const stri
             }
             if(!p_url.empty())
             {
-                element::ptr el = std::make_shared<el_image>(get_document());
+                element::ptr el = get_document()->make_node<el_image>(get_document());
                 el->set_attr("src", p_url.c_str());
                 el->set_attr("style", "display:inline-block");
                 el->set_tagName("img");
@@ -4,7 +4,7 @@
 
 litehtml::el_image::el_image(const document::ptr& doc) : html_tag(doc)
 {
-    m_css.set_display(display_inline_block);
+    css_w().set_display(display_inline_block);
 }
 
 void litehtml::el_image::get_content_size( size& sz, int /*max_width*/ )
@@ -114,7 +114,7 @@ litehtml::string litehtml::el_image::dump_get_name()
 
 std::shared_ptr<litehtml::render_item> litehtml::el_image::create_render_item(const std::shared_ptr<render_item>& parent_ri)
 {
-    auto ret = std::make_shared<render_item_image>(shared_from_this());
+    auto ret = get_document()->make_node<render_item_image>(shared_from_this());
     ret->parent(parent_ri);
     return ret;
 }
@@ -2,7 +2,7 @@
 #include "../include/litehtml/document_litehtml.h"
 #include "../include/litehtml/el_space.h"
 
-litehtml::el_space::el_space(const char* text, const std::shared_ptr<document>& doc) : el_text(text, doc)
+litehtml::el_space::el_space(tstring_view text, const std::shared_ptr<document>& doc) : el_text(text, doc)
 {
 }
 
@@ -38,7 +38,26 @@ bool litehtml::el_space::is_space() const
     return true;
 }
 
+bool litehtml::el_space::split_run(elements_list& rest)
+{
+    white_space ws = css().get_white_space();
+    // the rendered elements keep their text
+    if(m_text.size() < 2 || (ws != white_space_pre && ws != white_space_pre_wrap) || !m_renders.empty())
+    {
+        return false;
+    }
+    for(size_t i = 1; i < m_text.size(); i++)
+    {
+        rest.push_back(get_document()->make_node<el_space>(tstring_view(m_text.data() + i, 1), get_document()));
+    }
+    m_text_storage.assign(m_text.data(), 1);
+    m_text = tstring_view(m_text_storage.c_str(), m_text_storage.size());
+    // the tab expansion depends on the text
+    compute_styles(false);
+    return true;
+}
+
 litehtml::string litehtml::el_space::dump_get_name()
 {
-    return "space: \"" + get_escaped_string(m_text) + "\"";
+    return "space: \"" + get_escaped_string(string(m_text.data(), m_text.size())) + "\"";
 }
@@ -2,15 +2,35 @@
 #include "../include/litehtml/el_text.h"
 #include "../include/litehtml/render_item.h"
 
-litehtml::el_text::el_text(const char* text, const document::ptr& doc) : element(doc)
+// style of all text before compute_styles
+static const litehtml::css_properties::ptr& initial_text_css()
 {
-    if(text)
+    static const litehtml::css_properties::ptr css = []()
+        {
+            auto ret = std::make_shared<litehtml::css_properties>();
+            ret->set_display(litehtml::display_inline_text);
+            return ret;
+        }();
+    return css;
+}
+
+litehtml::el_text::el_text(tstring_view text, const document::ptr& doc) : element(doc)
+{
+    if(text.data())
+    {
+        m_text = doc->store_text(text.data(), text.size());
+        if(!m_text.data())
+        {
+            m_text_storage.assign(text.data(), text.size());
+        }
+    }
+    if(!m_text.data())
     {
-        m_text = text;
+        m_text = tstring_view(m_text_storage.c_str(), m_text_storage.size());
     }
     m_use_transformed	= false;
     m_draw_spaces		= true;
-    css_w().set_display(display_inline_text);
+    m_css				= initial_text_css();
 }
 
 void litehtml::el_text::get_content_size( size& sz, int /*max_width*/ )
@@ -20,47 +40,62 @@ void litehtml::el_text::get_content_size( size& sz, int /*max_width*/ )
 
 void litehtml::el_text::get_text( string& text )
 {
-    text += m_text;
+    text.append(m_text.data(), m_text.size());
 }
 
 void litehtml::el_text::compute_styles(bool /*recursive*/)
 {
-    element::ptr el_parent = parent();
-    if (el_parent)
-    {
-        css_w().set_line_height(el_parent->css().get_line_height());
-        css_w().set_font(el_parent->css().get_font());
-        css_w().set_font_metrics(el_parent->css().get_font_metrics());
-        css_w().set_white_space(el_parent->css().get_white_space());
-        css_w().set_text_transform(el_parent->css().get_text_transform());
-    }
-    css_w().set_display(display_inline_text);
-    css_w().set_float(float_none);
-
-    if(m_css.get_text_transform() != text_transform_none)
+    // the style of text depends only on the parent, so text siblings share it
+    style_sharing_candidates* siblings = get_document()->m_style_siblings;
+    if (siblings && siblings->text_css())
     {
-        m_transformed_text	= m_text;
-        m_use_transformed = true;
-        get_document()->container()->transform_text(m_transformed_text, m_css.get_text_transform());
+        m_css = siblings->text_css();
     } else
     {
-        m_use_transformed = false;
-    }
+        m_css = std::make_shared<css_properties>();
 
-    element::ptr p = parent();
-    while(p && p->css().get_display() == display_inline)
-    {
-        if(p->css().get_position() == element_position_relative)
+        element::ptr el_parent = parent();
+        if (el_parent)
         {
-            css_w().set_offsets(p->css().get_offsets());
-            css_w().set_position(element_position_relative);
-            break;
+            css_w().set_line_height(el_parent->css().get_line_height());
+            css_w().set_font(el_parent->css().get_font());
+            css_w().set_font_metrics(el_parent->css().get_font_metrics());
+            css_w().set_white_space(el_parent->css().get_white_space());
+            css_w().set_text_transform(el_parent->css().get_text_transform());
+        }
+        css_w().set_display(display_inline_text);
+        css_w().set_float(float_none);
+
+        element::ptr p = parent();
+        while(p && p->css().get_display() == display_inline)
+        {
+            if(p->css().get_position() == element_position_relative)
+            {
+                css_w().set_offsets(p->css().get_offsets());
+                css_w().set_position(element_position_relative);
+                break;
+            }
+            p = p->parent();
+        }
+        if(p)
+        {
+            css_w().set_position(element_position_static);
+        }
+
+        if (siblings)
+        {
+            siblings->text_css(m_css);
         }
-        p = p->parent();
     }
-    if(p)
+
+    if(css().get_text_transform() != text_transform_none)
     {
-        css_w().set_position(element_position_static);
+        m_transformed_text.assign(m_text.data(), m_text.size());
+        m_use_transformed = true;
+        get_document()->container()->transform_text(m_transformed_text, css().get_text_transform());
+    } else
+    {
+        m_use_transformed = false;
     }
 
     if(is_white_space())
@@ -69,9 +104,19 @@ void litehtml::el_text::compute_styles(bool /*recursive*/)
         m_use_transformed = true;
     } else
     {
-        if(m_text == "\t")
+        if(is_space() && std::find(m_text.begin(), m_text.end(), '\t') != m_text.end())
         {
-            m_transformed_text = "    ";
+            m_transformed_text.clear();
+            for(char c : m_text)
+            {
+                if(c == '\t')
+                {
+                    m_transformed_text += "    ";
+                } else
+                {
+                    m_transformed_text += c;
+                }
+            }
             m_use_transformed = true;
         }
         if(m_text == "\n" || m_text == "\r")
@@ -81,13 +126,9 @@ void litehtml::el_text::compute_styles(bool /*recursive*/)
         }
     }
 
-    font_metrics fm;
-    uint_ptr font = 0;
-    if (el_parent)
-    {
-        font = el_parent->css().get_font();
-        fm = el_parent->css().get_font_metrics();
-    }
+    // font and metrics come from the parent
+    const font_metrics& fm = css().get_font_metrics();
+    uint_ptr font = css().get_font();
     if(is_break() || !font)
     {
         m_size.height	= 0;
@@ -95,7 +136,7 @@ void litehtml::el_text::compute_styles(bool /*recursive*/)
     } else
     {
         m_size.height	= fm.height;
-        m_size.width	= get_document()->container()->text_width(m_use_transformed ? m_transformed_text.c_str() : m_text.c_str(), font);
+        m_size.width	= get_document()->container()->text_width(m_use_transformed ? m_transformed_text.c_str() : m_text.data(), font);
     }
     m_draw_spaces = fm.draw_spaces;
 }
@@ -138,7 +179,7 @@ void litehtml::el_text::draw(uint_ptr hdc, int x, int y, const position *clip, c
                     color = el_parent->css().get_color();
                 }
 
-                doc->container()->draw_text(hdc, m_use_transformed ? m_transformed_text.c_str() : m_text.c_str(), font,
+                doc->container()->draw_text(hdc, m_use_transformed ? m_transformed_text.c_str() : m_text.data(), font,
                                             color, pos);
             }
         }
@@ -147,7 +188,7 @@ void litehtml::el_text::draw(uint_ptr hdc, int x, int y, const position *clip, c
 
 litehtml::string litehtml::el_text::dump_get_name()
 {
-    return "text: \"" + get_escaped_string(m_text) + "\"";
+    return "text: \"" + get_escaped_string(string(m_text.data(), m_text.size())) + "\"";
 }
 
 std::vector<std::tuple<litehtml::string, litehtml::string>> litehtml::el_text::dump_get_attrs()
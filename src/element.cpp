@@ -13,7 +13,7 @@ namespace litehtml
 #define LITEHTML_EMPTY_FUNC			{}
 #define LITEHTML_RETURN_FUNC(ret)	{return ret;}
 
-element::element(const document::ptr& doc) : m_doc(doc)
+element::element(const document::ptr& doc) : m_doc(doc), m_css(css_properties::initial())
 {
 }
 
@@ -97,7 +97,7 @@ string element::dump_get_name()
 
 std::vector<std::tuple<string, string>> element::dump_get_attrs()
 {
-    return m_css.dump_get_attrs();
+    return m_css->dump_get_attrs();
 }
 
 void element::dump(dumper& cout)
@@ -138,26 +138,26 @@ std::shared_ptr<render_item> element::create_render_item(const std::shared_ptr<r
        css().get_display() == display_table_header_group ||
        css().get_display() == display_table_row_group)
     {
-        ret = std::make_shared<render_item_table_part>(shared_from_this());
+        ret = get_document()->make_node<render_item_table_part>(shared_from_this());
     } else if(css().get_display() == display_table_row)
     {
-        ret = std::make_shared<render_item_table_row>(shared_from_this());
+        ret = get_document()->make_node<render_item_table_row>(shared_from_this());
     } else if(css().get_display() == display_block ||
                 css().get_display() == display_table_cell ||
                 css().get_display() == display_table_caption ||
                 css().get_display() == display_list_item ||
                 css().get_display() == display_inline_block)
     {
-        ret = std::make_shared<render_item_block>(shared_from_this());
+        ret = get_document()->make_node<render_item_block>(shared_from_this());
     } else if(css().get_display() == display_table || css().get_display() == display_inline_table)
     {
-        ret = std::make_shared<render_item_table>(shared_from_this());
+        ret = get_document()->make_node<render_item_table>(shared_from_this());
     } else if(css().get_display() == display_inline || css().get_display() == display_inline_text)
     {
-        ret = std::make_shared<render_item_inline>(shared_from_this());
+        ret = get_document()->make_node<render_item_inline>(shared_from_this());
     } else if(css().get_display() == display_flex || css().get_display() == display_inline_flex)
     {
-        ret = std::make_shared<render_item_flex>(shared_from_this());
+        ret = get_document()->make_node<render_item_flex>(shared_from_this());
     }
     if(ret)
     {
@@ -190,9 +190,10 @@ std::shared_ptr<render_item> element::create_render_item(const std::shared_ptr<r
 
 bool element::requires_styles_update()
 {
+    document::ptr doc = get_document();
     for (const auto& used_style : m_used_styles)
     {
-        if(used_style->m_selector->is_media_valid())
+        if(used_style->m_selector->is_media_valid(doc.get()))
         {
             int res = select(*(used_style->m_selector), true);
             if( (res == select_no_match && used_style->m_used) || (res == select_match && !used_style->m_used) )
@@ -204,11 +205,42 @@ bool element::requires_styles_update()
     return false;
 }
 
+void element::apply_stylesheet(const litehtml::css& stylesheet)
+{
+    // called for a child by the running recursion, the filter already holds the ancestors
+    document::ptr doc = get_document();
+    if(doc->m_ancestor_filter)
+    {
+        apply_stylesheet(stylesheet, *doc->m_ancestor_filter);
+        return;
+    }
+
+    // seed the ancestor filter with the existing parents, children push themselves while recursing
+    ancestor_filter filter;
+    for(element::ptr el = parent(); el; el = el->parent())
+    {
+        el->update_ancestor_filter(filter, true);
+    }
+    apply_stylesheet(stylesheet, filter);
+}
+
 void element::add_render(const std::shared_ptr<render_item>& ri)
 {
     m_renders.push_back(ri);
 }
 
+void element::set_needs_layout()
+{
+    for(const auto& weak_ri : m_renders)
+    {
+        auto ri = weak_ri.lock();
+        if(ri)
+        {
+            ri->set_needs_layout();
+        }
+    }
+}
+
 bool element::find_styles_changes( position::vector& redraw_boxes)
 {
     if(css().get_display() == display_inline_text)
@@ -244,6 +276,7 @@ bool element::find_styles_changes( position::vector& redraw_boxes)
 
         refresh_styles();
         compute_styles();
+        set_needs_layout();
         ret = true;
     }
     for (auto& el : m_children)
@@ -261,11 +294,11 @@ element::ptr element::_add_before_after(int type, const style& /*style*/)
     element::ptr el;
     if(type == 0)
     {
-        el = std::make_shared<el_before>(get_document());
+        el = get_document()->make_node<el_before>(get_document());
         m_children.insert(m_children.begin(), el);
     } else
     {
-        el = std::make_shared<el_after>(get_document());
+        el = get_document()->make_node<el_after>(get_document());
         m_children.insert(m_children.end(), el);
     }
     el->parent(shared_from_this());
@@ -274,14 +307,14 @@ element::ptr element::_add_before_after(int type, const style& /*style*/)
 
 bool element::is_block_formatting_context() const
 {
-    if(	m_css.get_display() == display_inline_block ||
-           m_css.get_display() == display_table_cell ||
-           m_css.get_display() == display_table_caption ||
+    if(	css().get_display() == display_inline_block ||
+           css().get_display() == display_table_cell ||
+           css().get_display() == display_table_caption ||
            is_root() ||
-           m_css.get_float() != float_none ||
-           m_css.get_position() == element_position_absolute ||
-           m_css.get_position() == element_position_fixed ||
-           m_css.get_overflow() > overflow_visible)
+           css().get_float() != float_none ||
+           css().get_position() == element_position_absolute ||
+           css().get_position() == element_position_fixed ||
+           css().get_overflow() > overflow_visible)
     {
         return true;
     }
@@ -310,7 +343,8 @@ const char* element::get_tagName() const							LITEHTML_RETURN_FUNC("")
 void element::set_tagName( const char* /*tag*/ )						LITEHTML_EMPTY_FUNC
 void element::set_data( const char* /*data*/ )							LITEHTML_EMPTY_FUNC
 void element::set_attr( const char* /*name*/, const char* /*val*/ )			LITEHTML_EMPTY_FUNC
-void element::apply_stylesheet( const litehtml::css& /*stylesheet*/ )	LITEHTML_EMPTY_FUNC
+void element::apply_stylesheet( const litehtml::css& /*stylesheet*/, ancestor_filter& /*filter*/ )	LITEHTML_EMPTY_FUNC
+void element::update_ancestor_filter( ancestor_filter& /*filter*/, bool /*add*/ ) const	LITEHTML_EMPTY_FUNC
 void element::refresh_styles()										LITEHTML_EMPTY_FUNC
 void element::on_click()											LITEHTML_EMPTY_FUNC
 void element::compute_styles( bool /*recursive*/ )						LITEHTML_EMPTY_FUNC
@@ -341,6 +375,7 @@ int_vector		element::get_int_vector_property	(string_id /*name*/, bool /*inherit
 length_vector	element::get_length_vector_property	(string_id /*name*/, bool /*inherited*/, const length_vector& /*default_value*/, uint_ptr /*css_properties_member_offset*/) const LITEHTML_RETURN_FUNC({})
 size_vector		element::get_size_vector_property	(string_id /*name*/, bool /*inherited*/, const size_vector& /*default_value*/, uint_ptr /*css_properties_member_offset*/) const LITEHTML_RETURN_FUNC({})
 string			element::get_custom_property		(string_id /*name*/, const string& /*defval*/) const LITEHTML_RETURN_FUNC("")
+const style*	element::get_style					() const LITEHTML_RETURN_FUNC(nullptr)
 void element::get_text( string& /*text*/ )									LITEHTML_EMPTY_FUNC
 void element::parse_attributes()										LITEHTML_EMPTY_FUNC
 int element::select(const string& /*selector*/)								LITEHTML_RETURN_FUNC(select_no_match)
@@ -1,6 +1,109 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/render_item.h"
 #include "../include/litehtml/formatting_context.h"
+#include <climits>
+#include <queue>
+
+void litehtml::floats_index::insert(floated_box&& fb)
+{
+    // floats are placed from top to bottom, so in most cases they are appended
+    size_t idx = upper_bound(fb.pos.top());
+    if(idx == m_boxes.size() && idx < m_leaves)
+    {
+        m_boxes.push_back(std::move(fb));
+        update_leaf(idx);
+    } else
+    {
+        m_boxes.insert(m_boxes.begin() + (std::ptrdiff_t) idx, std::move(fb));
+        rebuild();
+    }
+}
+
+bool litehtml::floats_index::erase_context(int context)
+{
+    auto last = std::remove_if(m_boxes.begin(), m_boxes.end(), [context](const floated_box& fb) { return fb.context >= context; });
+    if(last == m_boxes.end())
+    {
+        return false;
+    }
+    m_boxes.erase(last, m_boxes.end());
+    rebuild();
+    return true;
+}
+
+bool litehtml::floats_index::shift(int dy, const std::shared_ptr<render_item> &parent)
+{
+    bool ret = false;
+    for(auto& fb : m_boxes)
+    {
+        if(fb.el->src_el()->is_ancestor(parent->src_el()))
+        {
+            fb.pos.y += dy;
+            ret = true;
+        }
+    }
+    if(ret)
+    {
+        std::stable_sort(m_boxes.begin(), m_boxes.end(), [](const floated_box& a, const floated_box& b) { return a.pos.top() < b.pos.top(); });
+        rebuild();
+    }
+    return ret;
+}
+
+size_t litehtml::floats_index::lower_bound(int y) const
+{
+    return (size_t) (std::lower_bound(m_boxes.begin(), m_boxes.end(), y, [](const floated_box& fb, int val) { return fb.pos.top() < val; }) - m_boxes.begin());
+}
+
+size_t litehtml::floats_index::upper_bound(int y) const
+{
+    return (size_t) (std::upper_bound(m_boxes.begin(), m_boxes.end(), y, [](int val, const floated_box& fb) { return val < fb.pos.top(); }) - m_boxes.begin());
+}
+
+void litehtml::floats_index::rebuild()
+{
+    // reserve room for appending
+    m_leaves = 1;
+    while(m_leaves <= m_boxes.size())
+    {
+        m_leaves *= 2;
+    }
+    m_max_bottom.assign(m_leaves * 2, INT_MIN);
+    m_clear_left_top	= 0;
+    m_clear_right_top	= 0;
+    for(size_t i = 0; i < m_boxes.size(); i++)
+    {
+        m_max_bottom[m_leaves + i] = m_boxes[i].pos.bottom();
+        update_cleared_tops(m_boxes[i]);
+    }
+    for(size_t node = m_leaves - 1; node > 0; node--)
+    {
+        m_max_bottom[node] = std::max(m_max_bottom[node * 2], m_max_bottom[node * 2 + 1]);
+    }
+}
+
+void litehtml::floats_index::update_leaf(size_t idx)
+{
+    size_t node = m_leaves + idx;
+    m_max_bottom[node] = m_boxes[idx].pos.bottom();
+    for(node /= 2; node > 0; node /= 2)
+    {
+        m_max_bottom[node] = std::max(m_max_bottom[node * 2], m_max_bottom[node * 2 + 1]);
+    }
+    update_cleared_tops(m_boxes[idx]);
+}
+
+void litehtml::floats_index::update_cleared_tops(const floated_box& fb)
+{
+    if(fb.clear_floats == clear_left || fb.clear_floats == clear_both)
+    {
+        m_clear_left_top = std::max(m_clear_left_top, fb.pos.top());
+    }
+    if(fb.clear_floats == clear_right || fb.clear_floats == clear_both)
+    {
+        m_clear_right_top = std::max(m_clear_right_top, fb.pos.top());
+    }
+}
 
 void litehtml::formatting_context::add_float(const std::shared_ptr<render_item> &el, int min_width, int context)
 {
@@ -17,151 +120,36 @@ void litehtml::formatting_context::add_float(const std::shared_ptr<render_item>
 
     if(fb.float_side == float_left)
     {
-        if(m_floats_left.empty())
-        {
-            m_floats_left.push_back(fb);
-        } else
-        {
-            bool inserted = false;
-            for(auto i = m_floats_left.begin(); i != m_floats_left.end(); i++)
-            {
-                if(fb.pos.right() > i->pos.right())
-                {
-                    m_floats_left.insert(i, std::move(fb));
-                    inserted = true;
-                    break;
-                }
-            }
-            if(!inserted)
-            {
-                m_floats_left.push_back(std::move(fb));
-            }
-        }
+        m_floats_left.insert(std::move(fb));
         m_cache_line_left.invalidate();
     } else if(fb.float_side == float_right)
     {
-        if(m_floats_right.empty())
-        {
-            m_floats_right.push_back(std::move(fb));
-        } else
-        {
-            bool inserted = false;
-            for(auto i = m_floats_right.begin(); i != m_floats_right.end(); i++)
-            {
-                if(fb.pos.left() < i->pos.left())
-                {
-                    m_floats_right.insert(i, std::move(fb));
-                    inserted = true;
-                    break;
-                }
-            }
-            if(!inserted)
-            {
-                m_floats_right.push_back(fb);
-            }
-        }
+        m_floats_right.insert(std::move(fb));
         m_cache_line_right.invalidate();
     }
 }
 
 int litehtml::formatting_context::get_floats_height(element_float el_float) const
 {
-    int h = 0;
-
-    for(const auto& fb : m_floats_left)
+    int h;
+    if(el_float == float_none)
     {
-        bool process = false;
-        switch(el_float)
-        {
-            case float_none:
-                process = true;
-                break;
-            case float_left:
-                if (fb.clear_floats == clear_left || fb.clear_floats == clear_both)
-                {
-                    process = true;
-                }
-                break;
-            case float_right:
-                if (fb.clear_floats == clear_right || fb.clear_floats == clear_both)
-                {
-                    process = true;
-                }
-                break;
-        }
-        if(process)
-        {
-            if(el_float == float_none)
-            {
-                h = std::max(h, fb.pos.bottom());
-            } else
-            {
-                h = std::max(h, fb.pos.top());
-            }
-        }
-    }
-
-
-    for(const auto& fb : m_floats_right)
+        h = std::max(m_floats_left.max_bottom(), m_floats_right.max_bottom());
+    } else
     {
-        int process = false;
-        switch(el_float)
-        {
-            case float_none:
-                process = true;
-                break;
-            case float_left:
-                if (fb.clear_floats == clear_left || fb.clear_floats == clear_both)
-                {
-                    process = true;
-                }
-                break;
-            case float_right:
-                if (fb.clear_floats == clear_right || fb.clear_floats == clear_both)
-                {
-                    process = true;
-                }
-                break;
-        }
-        if(process)
-        {
-            if(el_float == float_none)
-            {
-                h = std::max(h, fb.pos.bottom());
-            } else
-            {
-                h = std::max(h, fb.pos.top());
-            }
-        }
+        h = std::max(m_floats_left.max_cleared_top(el_float), m_floats_right.max_cleared_top(el_float));
     }
-
     return h - m_current_top;
 }
 
 int litehtml::formatting_context::get_left_floats_height() const
 {
-    int h = 0;
-    if(!m_floats_left.empty())
-    {
-        for (const auto& fb : m_floats_left)
-        {
-            h = std::max(h, fb.pos.bottom());
-        }
-    }
-    return h - m_current_top;
+    return m_floats_left.max_bottom() - m_current_top;
 }
 
 int litehtml::formatting_context::get_right_floats_height() const
 {
-    int h = 0;
-    if(!m_floats_right.empty())
-    {
-        for(const auto& fb : m_floats_right)
-        {
-            h = std::max(h, fb.pos.bottom());
-        }
-    }
-    return h - m_current_top;
+    return m_floats_right.max_bottom() - m_current_top;
 }
 
 int litehtml::formatting_context::get_line_left(int y )
@@ -178,17 +166,7 @@ int litehtml::formatting_context::get_line_left(int y )
     }
 
     int w = 0;
-    for(const auto& fb : m_floats_left)
-    {
-        if (y >= fb.pos.top() && y < fb.pos.bottom())
-        {
-            w = std::max(w, fb.pos.right());
-            if (w < fb.pos.right())
-            {
-                break;
-            }
-        }
-    }
+    m_floats_left.for_each_at(y, [&w](const floated_box& fb) { w = std::max(w, fb.pos.right()); });
     m_cache_line_left.set_value(y, w);
     w -= m_current_left;
     if(w < 0) return 0;
@@ -214,18 +192,11 @@ int litehtml::formatting_context::get_line_right(int y, int def_right )
 
     int w = def_right;
     m_cache_line_right.is_default = true;
-    for(const auto& fb : m_floats_right)
-    {
-        if(y >= fb.pos.top() && y < fb.pos.bottom())
+    m_floats_right.for_each_at(y, [this, &w](const floated_box& fb)
         {
             w = std::min(w, fb.pos.left());
             m_cache_line_right.is_default = false;
-            if(w > fb.pos.left())
-            {
-                break;
-            }
-        }
-    }
+        });
     m_cache_line_right.set_value(y, w);
     w -= m_current_left;
     if(w < 0) return 0;
@@ -235,30 +206,13 @@ int litehtml::formatting_context::get_line_right(int y, int def_right )
 
 void litehtml::formatting_context::clear_floats(int context)
 {
-    auto iter = m_floats_left.begin();
-    while(iter != m_floats_left.end())
+    if(m_floats_left.erase_context(context))
     {
-        if(iter->context >= context)
-        {
-            iter = m_floats_left.erase(iter);
-            m_cache_line_left.invalidate();
-        } else
-        {
-            iter++;
-        }
+        m_cache_line_left.invalidate();
     }
-
-    iter = m_floats_right.begin();
-    while(iter != m_floats_right.end())
+    if(m_floats_right.erase_context(context))
     {
-        if(iter->context >= context)
-        {
-            iter = m_floats_right.erase(iter);
-            m_cache_line_right.invalidate();
-        } else
-        {
-            iter++;
-        }
+        m_cache_line_right.invalidate();
     }
 }
 
@@ -312,61 +266,44 @@ int litehtml::formatting_context::find_next_line_top(int top, int width, int def
     top += m_current_top;
     def_right += m_current_left;
 
-    int new_top = top;
-    int_vector points;
+    // the line width changes at the float edges only, they are tried from top to bottom
+    std::priority_queue<int, std::vector<int>, std::greater<int>> bottoms;
+    auto add_bottom = [&bottoms](const floated_box& fb) { bottoms.push(fb.pos.bottom()); };
+    size_t left_idx = m_floats_left.lower_bound(top);
+    size_t right_idx = m_floats_right.lower_bound(top);
+    m_floats_left.for_each(left_idx, top, add_bottom);
+    m_floats_right.for_each(right_idx, top, add_bottom);
+    auto next_left = m_floats_left.begin() + (std::ptrdiff_t) left_idx;
+    auto next_right = m_floats_right.begin() + (std::ptrdiff_t) right_idx;
 
-    for(const auto& fb : m_floats_left)
+    int new_top = top;
+    while(next_left != m_floats_left.end() || next_right != m_floats_right.end() || !bottoms.empty())
     {
-        if(fb.pos.top() >= top)
+        int pt = INT_MAX;
+        if(next_left != m_floats_left.end()) pt = next_left->pos.top();
+        if(next_right != m_floats_right.end()) pt = std::min(pt, next_right->pos.top());
+        if(!bottoms.empty()) pt = std::min(pt, bottoms.top());
+
+        for(; next_left != m_floats_left.end() && next_left->pos.top() == pt; next_left++)
         {
-            if(find(points.begin(), points.end(), fb.pos.top()) == points.end())
-            {
-                points.push_back(fb.pos.top());
-            }
+            bottoms.push(next_left->pos.bottom());
         }
-        if (fb.pos.bottom() >= top)
+        for(; next_right != m_floats_right.end() && next_right->pos.top() == pt; next_right++)
         {
-            if (find(points.begin(), points.end(), fb.pos.bottom()) == points.end())
-            {
-                points.push_back(fb.pos.bottom());
-            }
+            bottoms.push(next_right->pos.bottom());
         }
-    }
-
-    for (const auto& fb : m_floats_right)
-    {
-        if (fb.pos.top() >= top)
+        while(!bottoms.empty() && bottoms.top() == pt)
         {
-            if (find(points.begin(), points.end(), fb.pos.top()) == points.end())
-            {
-                points.push_back(fb.pos.top());
-            }
-        }
-        if (fb.pos.bottom() >= top)
-        {
-            if (find(points.begin(), points.end(), fb.pos.bottom()) == points.end())
-            {
-                points.push_back(fb.pos.bottom());
-            }
+            bottoms.pop();
         }
-    }
-
-    if(!points.empty())
-    {
-        sort(points.begin(), points.end(), std::less<int>( ));
-        new_top = points.back();
 
-        for(auto pt : points)
+        new_top = pt;
+        int pos_left	= 0;
+        int pos_right	= def_right;
+        get_line_left_right(pt - m_current_top, def_right - m_current_left, pos_left, pos_right);
+        if(pos_right - pos_left >= width)
         {
-            int pos_left	= 0;
-            int pos_right	= def_right;
-            get_line_left_right(pt - m_current_top, def_right - m_current_left, pos_left, pos_right);
-
-            if(pos_right - pos_left >= width)
-            {
-                new_top = pt;
-                break;
-            }
+            break;
         }
     }
     return new_top - m_current_top;
@@ -374,29 +311,11 @@ int litehtml::formatting_context::find_next_line_top(int top, int width, int def
 
 void litehtml::formatting_context::update_floats(int dy, const std::shared_ptr<render_item> &parent)
 {
-    bool reset_cache = false;
-    for(auto fb = m_floats_left.rbegin(); fb != m_floats_left.rend(); fb++)
-    {
-        if(fb->el->src_el()->is_ancestor(parent->src_el()))
-        {
-            reset_cache	= true;
-            fb->pos.y	+= dy;
-        }
-    }
-    if(reset_cache)
+    if(m_floats_left.shift(dy, parent))
     {
         m_cache_line_left.invalidate();
     }
-    reset_cache = false;
-    for(auto fb = m_floats_right.rbegin(); fb != m_floats_right.rend(); fb++)
-    {
-        if(fb->el->src_el()->is_ancestor(parent->src_el()))
-        {
-            reset_cache	= true;
-            fb->pos.y	+= dy;
-        }
-    }
-    if(reset_cache)
+    if(m_floats_right.shift(dy, parent))
     {
         m_cache_line_right.invalidate();
     }
@@ -414,13 +333,13 @@ int litehtml::formatting_context::find_min_left(int y, int context_idx)
 {
     y += m_current_top;
     int min_left = m_current_left;
-    for(const auto& fb : m_floats_left)
-    {
-        if (y >= fb.pos.top() && y < fb.pos.bottom() && fb.context == context_idx)
+    m_floats_left.for_each_at(y, [&min_left, context_idx](const floated_box& fb)
         {
-            min_left += fb.min_width;
-        }
-    }
+            if (fb.context == context_idx)
+            {
+                min_left += fb.min_width;
+            }
+        });
     if(min_left < m_current_left) return 0;
     return min_left - m_current_left;
 }
@@ -429,13 +348,13 @@ int litehtml::formatting_context::find_min_right(int y, int right, int context_i
 {
     y += m_current_top;
     int min_right = right + m_current_left;
-    for(const auto& fb : m_floats_right)
-    {
-        if (y >= fb.pos.top() && y < fb.pos.bottom() && fb.context == context_idx)
+    m_floats_right.for_each_at(y, [&min_right, context_idx](const floated_box& fb)
         {
-            min_right -= fb.min_width;
-        }
-    }
+            if (fb.context == context_idx)
+            {
+                min_right -= fb.min_width;
+            }
+        });
     if(min_right < m_current_left) return 0;
     return min_right - m_current_left;
 }
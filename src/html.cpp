@@ -84,7 +84,7 @@ int litehtml::value_index( const string& val, const string& strings, int defValu
         }
         if(item_len == val.length())
         {
-            if(val == strings.substr(delim_start, item_len))
+            if(!strings.compare(delim_start, item_len, val))
             {
                 return idx;
             }
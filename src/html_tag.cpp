@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <locale>
 #include "../include/litehtml/el_before_after.h"
+#include "../include/litehtml/el_space.h"
 #include "../include/litehtml/num_cvt.h"
 #include "../include/litehtml/line_box.h"
 #include <stack>
@@ -176,26 +177,41 @@ litehtml::element::ptr litehtml::html_tag::select_one( const css_selector& selec
     return nullptr;
 }
 
-void litehtml::html_tag::apply_stylesheet( const litehtml::css& stylesheet )
+void litehtml::html_tag::update_ancestor_filter(ancestor_filter& filter, bool add) const
+{
+    auto update = [&](unsigned hash)
+        {
+            if(add) filter.add(hash); else filter.remove(hash);
+        };
+    update(ancestor_filter::tag_hash(m_tag));
+    if(m_id != empty_id)
+    {
+        update(ancestor_filter::id_hash(m_id));
+    }
+    for(auto cls : m_classes)
+    {
+        update(ancestor_filter::class_hash(cls));
+    }
+}
+
+void litehtml::html_tag::apply_stylesheet( const litehtml::css& stylesheet, ancestor_filter& filter )
 {
     if(is_root())
     {
     }
-    for(const auto& sel : stylesheet.selectors())
+    // test only the rules whose rightmost id/class/tag can match this element
+    std::vector<int> candidates;
+    stylesheet.get_candidates(m_tag, m_id, m_classes, candidates);
+    document::ptr doc = get_document();
+
+    for(int idx : candidates)
     {
-        // optimization
-        {
-            const auto& r = sel->m_right;
-            if (r.m_tag != star_id && r.m_tag != m_tag)
-                continue;
+        const css_selector::ptr& sel = stylesheet.selectors()[idx];
 
-            if (!r.m_attrs.empty())
-            {
-                const auto& attr = r.m_attrs[0];
-                if (attr.type == select_class &&
-                    std::find(m_classes.begin(), m_classes.end(), attr.name) == m_classes.end())
-                    continue;
-            }
+        // none of the ancestors can match the left-hand compounds
+        if(!filter.may_match(*sel))
+        {
+            continue;
         }
 
         int apply = select(*sel, false);
@@ -204,12 +220,12 @@ void litehtml::html_tag::apply_stylesheet( const litehtml::css& stylesheet )
         {
             used_selector::ptr us = std::unique_ptr<used_selector>(new used_selector(sel, false));
 
-            if(sel->is_media_valid())
+            if(sel->is_media_valid(doc.get()))
             {
                 auto apply_before_after = [&]()
                     {
                         const auto& content_property = sel->m_style->get_property(_content_);
-                        bool content_none = content_property.m_type == prop_type_string && content_property.m_string == "none";
+                        bool content_none = content_property.m_type == prop_type_string && content_property.get_string() == "none";
                         bool create = !content_none && (sel->m_right.m_attrs.size() > 1 || sel->m_right.m_tag != star_id);
 
                         element::ptr el;
@@ -269,6 +285,11 @@ void litehtml::html_tag::apply_stylesheet( const litehtml::css& stylesheet )
         }
     }
 
+    // the children are styled through apply_stylesheet(stylesheet), so the subclasses overriding
+    // it are called; it takes the filter from the document
+    update_ancestor_filter(filter, true);
+    ancestor_filter* parent_filter = doc->m_ancestor_filter;
+    doc->m_ancestor_filter = &filter;
     for(auto& el : m_children)
     {
         if(el->css().get_display() != display_inline_text)
@@ -276,12 +297,14 @@ void litehtml::html_tag::apply_stylesheet( const litehtml::css& stylesheet )
             el->apply_stylesheet(stylesheet);
         }
     }
+    doc->m_ancestor_filter = parent_filter;
+    update_ancestor_filter(filter, false);
 }
 
 void litehtml::html_tag::get_content_size( size& sz, int max_width )
 {
     sz.height	= 0;
-    if(m_css.get_display() == display_block)
+    if(css().get_display() == display_block)
     {
         sz.width	= max_width;
     } else
@@ -298,15 +321,15 @@ void litehtml::html_tag::draw(uint_ptr hdc, int x, int y, const position *clip,
 
     draw_background(hdc, x, y, clip, ri);
 
-    if(m_css.get_display() == display_list_item && m_css.get_list_style_type() != list_style_type_none)
+    if(css().get_display() == display_list_item && css().get_list_style_type() != list_style_type_none)
     {
-        if(m_css.get_overflow() > overflow_visible)
+        if(css().get_overflow() > overflow_visible)
         {
             position border_box = pos;
             border_box += ri->get_paddings();
             border_box += ri->get_borders();
 
-            border_radiuses bdr_radius = m_css.get_borders().radius.calc_percents(border_box.width, border_box.height);
+            border_radiuses bdr_radius = css().get_borders().radius.calc_percents(border_box.width, border_box.height);
 
             bdr_radius -= ri->get_borders();
             bdr_radius -= ri->get_paddings();
@@ -316,7 +339,7 @@ void litehtml::html_tag::draw(uint_ptr hdc, int x, int y, const position *clip,
 
         draw_list_marker(hdc, pos);
 
-        if(m_css.get_overflow() > overflow_visible)
+        if(css().get_overflow() > overflow_visible)
         {
             get_document()->container()->del_clip();
         }
@@ -329,7 +352,7 @@ litehtml::string litehtml::html_tag::get_custom_property(string_id name, const s
 
     if (value.m_type == prop_type_string)
     {
-        return value.m_string;
+        return value.get_string();
     }
     else if (auto _parent = parent())
     {
@@ -338,14 +361,14 @@ litehtml::string litehtml::html_tag::get_custom_property(string_id name, const s
     return default_value;
 }
 
-template<class Type, litehtml::property_type property_value_type, Type litehtml::property_value::* property_value_member>
+template<class Type, litehtml::property_type property_value_type, const Type& (litehtml::property_value::* property_value_getter)() const>
 const Type& litehtml::html_tag::get_property_impl(string_id name, bool inherited, const Type& default_value, uint_ptr css_properties_member_offset) const
 {
     const property_value& value = m_style.get_property(name);
 
     if (value.m_type == property_value_type)
     {
-        return value.*property_value_member;
+        return (value.*property_value_getter)();
     }
     else if (inherited || value.m_type == prop_type_inherit)
     {
@@ -361,47 +384,54 @@ const Type& litehtml::html_tag::get_property_impl(string_id name, bool inherited
 
 int litehtml::html_tag::get_enum_property(string_id name, bool inherited, int default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<int, prop_type_enum_item, &property_value::m_enum_item>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<int, prop_type_enum_item, &property_value::get_enum_item>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::css_length litehtml::html_tag::get_length_property(string_id name, bool inherited, css_length default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<css_length, prop_type_length, &property_value::m_length>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<css_length, prop_type_length, &property_value::get_length>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::web_color litehtml::html_tag::get_color_property(string_id name, bool inherited, web_color default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<web_color, prop_type_color, &property_value::m_color>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<web_color, prop_type_color, &property_value::get_color>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::string litehtml::html_tag::get_string_property(string_id name, bool inherited, const string& default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<string, prop_type_string, &property_value::m_string>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<string, prop_type_string, &property_value::get_string>(name, inherited, default_value, css_properties_member_offset);
 }
 
 float litehtml::html_tag::get_number_property(string_id name, bool inherited, float default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<float, prop_type_number, &property_value::m_number>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<float, prop_type_number, &property_value::get_number>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::string_vector litehtml::html_tag::get_string_vector_property(string_id name, bool inherited, const string_vector& default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<string_vector, prop_type_string_vector, &property_value::m_string_vector>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<string_vector, prop_type_string_vector, &property_value::get_string_vector>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::int_vector litehtml::html_tag::get_int_vector_property(string_id name, bool inherited, const int_vector& default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<int_vector, prop_type_enum_item_vector, &property_value::m_enum_item_vector>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<int_vector, prop_type_enum_item_vector, &property_value::get_enum_item_vector>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::length_vector litehtml::html_tag::get_length_vector_property(string_id name, bool inherited, const length_vector& default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<length_vector, prop_type_length_vector, &property_value::m_length_vector>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<length_vector, prop_type_length_vector, &property_value::get_length_vector>(name, inherited, default_value, css_properties_member_offset);
 }
 
 litehtml::size_vector litehtml::html_tag::get_size_vector_property(string_id name, bool inherited, const size_vector& default_value, uint_ptr css_properties_member_offset) const
 {
-    return get_property_impl<size_vector, prop_type_size_vector, &property_value::m_size_vector>(name, inherited, default_value, css_properties_member_offset);
+    return get_property_impl<size_vector, prop_type_size_vector, &property_value::get_size_vector>(name, inherited, default_value, css_properties_member_offset);
+}
+
+bool litehtml::html_tag::can_share_style(const html_tag& el) const
+{
+    // Computed styles depend only on the declarations and the parent's style.
+    // Siblings share the parent, so equal declarations give equal styles.
+    return m_tag == el.m_tag && m_style == el.m_style;
 }
 
 void litehtml::html_tag::compute_styles(bool recursive)
@@ -416,14 +446,44 @@ void litehtml::html_tag::compute_styles(bool recursive)
 
     m_style.subst_vars(this);
 
-    m_css.compute(this, doc);
+    style_sharing_candidates* siblings = doc->m_style_siblings;
+    html_tag* sibling = siblings ? siblings->find(*this) : nullptr;
+    if (sibling)
+    {
+        m_css = sibling->m_css;
+    } else
+    {
+        auto css = std::make_shared<css_properties>();
+        css->compute(this, doc);
+        m_css = std::move(css);
+    }
+    if (siblings)
+    {
+        siblings->add(this);
+    }
 
     if (recursive)
     {
-        for (const auto& el : m_children)
+        style_sharing_candidates children;
+        doc->m_style_siblings = &children;
+        for (auto el = m_children.begin(); el != m_children.end(); el++)
         {
-            el->compute_styles();
+            (*el)->compute_styles();
+            if ((*el)->is_space())
+            {
+                // the split characters are styled next
+                elements_list rest;
+                if (std::static_pointer_cast<el_space>(*el)->split_run(rest))
+                {
+                    for (const auto& chr : rest)
+                    {
+                        chr->parent(shared_from_this());
+                    }
+                    m_children.splice(std::next(el), rest);
+                }
+            }
         }
+        doc->m_style_siblings = siblings;
     }
 }
 
@@ -904,7 +964,7 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, int x, int y, const posit
     el_pos += ri->get_paddings();
     el_pos += ri->get_margins();
 
-    if(m_css.get_display() != display_inline && m_css.get_display() != display_table_row)
+    if(css().get_display() != display_inline && css().get_display() != display_table_row)
     {
         if(el_pos.does_intersect(clip) || is_root())
         {
@@ -932,10 +992,10 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, int x, int y, const posit
             border_box += ri->get_paddings();
             border_box += ri->get_borders();
 
-            borders bdr = m_css.get_borders();
+            borders bdr = css().get_borders();
             if(bdr.is_visible())
             {
-                bdr.radius = m_css.get_borders().radius.calc_percents(border_box.width, border_box.height);
+                bdr.radius = css().get_borders().radius.calc_percents(border_box.width, border_box.height);
                 get_document()->container()->draw_borders(hdc, bdr, border_box, is_root());
             }
         }
@@ -970,31 +1030,31 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, int x, int y, const posit
                 // set left borders radius for the first box
                 if(box == boxes.begin())
                 {
-                    bdr.radius.bottom_left_x	= m_css.get_borders().radius.bottom_left_x;
-                    bdr.radius.bottom_left_y	= m_css.get_borders().radius.bottom_left_y;
-                    bdr.radius.top_left_x		= m_css.get_borders().radius.top_left_x;
-                    bdr.radius.top_left_y		= m_css.get_borders().radius.top_left_y;
+                    bdr.radius.bottom_left_x	= css().get_borders().radius.bottom_left_x;
+                    bdr.radius.bottom_left_y	= css().get_borders().radius.bottom_left_y;
+                    bdr.radius.top_left_x		= css().get_borders().radius.top_left_x;
+                    bdr.radius.top_left_y		= css().get_borders().radius.top_left_y;
                 }
 
                 // set right borders radius for the last box
                 if(box == boxes.end() - 1)
                 {
-                    bdr.radius.bottom_right_x	= m_css.get_borders().radius.bottom_right_x;
-                    bdr.radius.bottom_right_y	= m_css.get_borders().radius.bottom_right_y;
-                    bdr.radius.top_right_x		= m_css.get_borders().radius.top_right_x;
-                    bdr.radius.top_right_y		= m_css.get_borders().radius.top_right_y;
+                    bdr.radius.bottom_right_x	= css().get_borders().radius.bottom_right_x;
+                    bdr.radius.bottom_right_y	= css().get_borders().radius.bottom_right_y;
+                    bdr.radius.top_right_x		= css().get_borders().radius.top_right_x;
+                    bdr.radius.top_right_y		= css().get_borders().radius.top_right_y;
                 }
 
 
-                bdr.top		= m_css.get_borders().top;
-                bdr.bottom	= m_css.get_borders().bottom;
+                bdr.top		= css().get_borders().top;
+                bdr.bottom	= css().get_borders().bottom;
                 if(box == boxes.begin())
                 {
-                    bdr.left	= m_css.get_borders().left;
+                    bdr.left	= css().get_borders().left;
                 }
                 if(box == boxes.end() - 1)
                 {
-                    bdr.right	= m_css.get_borders().right;
+                    bdr.right	= css().get_borders().right;
                 }
 
                 if(bg)
@@ -1212,7 +1272,7 @@ void litehtml::html_tag::init_one_background_paint(int i, position pos, backgrou
             bg_paint.position_y = bg_paint.origin_box.y + (int) position_y.calc_percent(bg_paint.origin_box.height - bg_paint.image_size.height);
         }
     }
-    bg_paint.border_radius	= m_css.get_borders().radius.calc_percents(border_box.width, border_box.height);
+    bg_paint.border_radius	= css().get_borders().radius.calc_percents(border_box.width, border_box.height);
     bg_paint.border_box		= border_box;
     bg_paint.is_root		= is_root();
 }
@@ -1268,9 +1328,9 @@ void litehtml::html_tag::draw_list_marker( uint_ptr hdc, const position& pos )
         lm.pos.height	= img_size.height;
     }
 
-    if (m_css.get_list_style_position() == list_style_position_outside)
+    if (css().get_list_style_position() == list_style_position_outside)
     {
-        if (m_css.get_list_style_type() >= list_style_type_armenian)
+        if (css().get_list_style_type() >= list_style_type_armenian)
         {
             if(lm.font)
             {
@@ -1288,7 +1348,7 @@ void litehtml::html_tag::draw_list_marker( uint_ptr hdc, const position& pos )
         }
     }
 
-    if (m_css.get_list_style_type() >= list_style_type_armenian)
+    if (css().get_list_style_type() >= list_style_type_armenian)
     {
         auto marker_text = get_list_marker_text(lm.index);
         lm.pos.height = ln_height;
@@ -1317,7 +1377,7 @@ void litehtml::html_tag::draw_list_marker( uint_ptr hdc, const position& pos )
 
 litehtml::string litehtml::html_tag::get_list_marker_text(int index)
 {
-    switch (m_css.get_list_style_type())
+    switch (css().get_list_style_type())
     {
     case litehtml::list_style_type_decimal:
         return std::to_string(index);
@@ -1564,11 +1624,12 @@ void litehtml::html_tag::refresh_styles()
 
     m_style.clear();
 
+    document::ptr doc = get_document();
     for (auto& usel : m_used_styles)
     {
         usel->m_used = false;
 
-        if(usel->m_selector->is_media_valid())
+        if(usel->m_selector->is_media_valid(doc.get()))
         {
             int apply = select(*usel->m_selector, false);
 
@@ -1628,14 +1689,14 @@ const litehtml::background* litehtml::html_tag::get_background(bool own_only)
     if(own_only)
     {
         // return own background with check for empty one
-        if(m_css.get_bg().is_empty())
+        if(css().get_bg().is_empty())
         {
             return nullptr;
         }
-        return &m_css.get_bg();
+        return &css().get_bg();
     }
 
-    if(m_css.get_bg().is_empty())
+    if(css().get_bg().is_empty())
     {
         // if this is root element (<html>) try to get background from body
         if (is_root())
@@ -1665,7 +1726,7 @@ const litehtml::background* litehtml::html_tag::get_background(bool own_only)
         }
     }
 
-    return &m_css.get_bg();
+    return &css().get_bg();
 }
 
 litehtml::string litehtml::html_tag::dump_get_name()
@@ -0,0 +1,69 @@
+#include "../include/litehtml/html.h"
+#include "../include/litehtml/keywords.h"
+
+litehtml::keyword_table::keyword_table(const char* list, char delim)
+{
+    std::vector<slot> keywords;
+    int index = 0;
+    for(const char* start = list; ; index++)
+    {
+        const char* end = strchr(start, delim);
+        if(!end) end = start + strlen(start);
+        if(end != start)
+        {
+            slot kw;
+            kw.str		= start;
+            kw.len		= end - start;
+            kw.index	= index;
+            keywords.push_back(kw);
+        }
+        if(!*end) break;
+        start = end + 1;
+    }
+
+    // Look for a seed that places every keyword into its own slot. With at least twice
+    // as many slots as keywords a few dozen seeds are usually enough.
+    size_t size = 8;
+    while(size < keywords.size() * 2) size *= 2;
+    for(uint32_t seed = 0; ; seed++)
+    {
+        if(seed == 256)
+        {
+            size *= 2;
+            seed = 0;
+        }
+        m_slots.assign(size, slot());
+        m_mask = (uint32_t) size - 1;
+        m_seed = seed;
+
+        bool ok = true;
+        for(const auto& kw : keywords)
+        {
+            slot& s = m_slots[hash(kw.str, kw.len, seed) & m_mask];
+            if(s.str)
+            {
+                // value_index returns the first of duplicated keywords
+                if(s.len == kw.len && !memcmp(s.str, kw.str, kw.len)) continue;
+                ok = false;
+                break;
+            }
+            s = kw;
+        }
+        if(ok) break;
+    }
+}
+
+#define LITEHTML_KEYWORD_TABLE(name)								\
+    const litehtml::keyword_table& litehtml::name##_keywords()		\
+    {																\
+        static const keyword_table table(name##_strings);			\
+        return table;												\
+    }
+LITEHTML_KEYWORD_LISTS(LITEHTML_KEYWORD_TABLE)
+#undef LITEHTML_KEYWORD_TABLE
+
+const litehtml::keyword_table& litehtml::content_property_keywords()
+{
+    static const keyword_table table(content_property_string);
+    return table;
+}
@@ -1,6 +1,7 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/media_query.h"
 #include "../include/litehtml/document_litehtml.h"
+#include "../include/litehtml/keywords.h"
 
 
 litehtml::media_query::media_query()
@@ -41,7 +42,7 @@ litehtml::media_query::ptr litehtml::media_query::create_from_string(const strin
             if(!expr_tokens.empty())
             {
                 trim(expr_tokens[0]);
-                expr.feature = (media_feature) value_index(expr_tokens[0], media_feature_strings, media_feature_none);
+                expr.feature = (media_feature) media_feature_keywords().find(expr_tokens[0], media_feature_none);
                 if(expr.feature != media_feature_none)
                 {
                     if(expr_tokens.size() == 1)
@@ -53,7 +54,7 @@ litehtml::media_query::ptr litehtml::media_query::create_from_string(const strin
                         expr.check_as_bool = false;
                         if(expr.feature == media_feature_orientation)
                         {
-                            expr.val = value_index(expr_tokens[1], media_orientation_strings, media_orientation_landscape);
+                            expr.val = media_orientation_keywords().find(expr_tokens[1], media_orientation_landscape);
                         } else
                         {
                             string::size_type slash_pos = expr_tokens[1].find('/');
@@ -88,7 +89,7 @@ litehtml::media_query::ptr litehtml::media_query::create_from_string(const strin
             }
         } else
         {
-            query->m_media_type = (media_type) value_index(token, media_type_strings, media_type_all);
+            query->m_media_type = (media_type) media_type_keywords().find(token, media_type_all);
 
         }
     }
@@ -148,22 +149,16 @@ litehtml::media_query_list::ptr litehtml::media_query_list::create_from_string(c
     return list;
 }
 
-bool litehtml::media_query_list::apply_media_features( const media_features& features )
+bool litehtml::media_query_list::check( const media_features& features ) const
 {
-    bool apply = false;
-
     for(auto & query : m_queries)
     {
         if(query->check(features))
         {
-            apply = true;
-            break;
+            return true;
         }
     }
-
-    bool ret = (apply != m_is_used);
-    m_is_used = apply;
-    return ret;
+    return false;
 }
 
 bool litehtml::media_query_expression::check( const media_features& features ) const
@@ -13,10 +13,14 @@ int litehtml::render_item_block::place_float(const std::shared_ptr<render_item>
 
     int ret_width = 0;
 
-    int min_rendered_width = el->render(line_left, line_top, self_size.new_width(line_right), fmt_ctx);
+    int min_rendered_width = el->max_content_width(self_size.new_width(line_right), fmt_ctx);
     if(min_rendered_width < el->width() && el->src_el()->css().get_width().is_predefined())
     {
         el->render(line_left, line_top, self_size.new_width(min_rendered_width), fmt_ctx);
+    } else
+    {
+        // returns at once if max_content_width() has just rendered it
+        el->render(line_left, line_top, self_size.new_width(line_right), fmt_ctx);
     }
 
     if (el->src_el()->css().get_float() == float_left)
@@ -123,7 +127,7 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
     }
     if(has_block_level)
     {
-        ret = std::make_shared<render_item_block_context>(src_el());
+        ret = src_el()->get_document()->make_node<render_item_block_context>(src_el());
         ret->parent(parent());
 
         auto doc = src_el()->get_document();
@@ -141,8 +145,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
             {
                 if(not_ws_added)
                 {
-                    auto anon_el = std::make_shared<html_tag>(src_el());
-                    auto anon_ri = std::make_shared<render_item_block>(anon_el);
+                    auto anon_el = src_el()->get_document()->make_node<html_tag>(src_el());
+                    auto anon_ri = src_el()->get_document()->make_node<render_item_block>(anon_el);
                     for(const auto& inl : inlines)
                     {
                         anon_ri->add_child(inl);
@@ -159,8 +163,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
         }
         if(!inlines.empty() && not_ws_added)
         {
-            auto anon_el = std::make_shared<html_tag>(src_el());
-            auto anon_ri = std::make_shared<render_item_block>(anon_el);
+            auto anon_el = src_el()->get_document()->make_node<html_tag>(src_el());
+            auto anon_ri = src_el()->get_document()->make_node<render_item_block>(anon_el);
             for(const auto& inl : inlines)
             {
                 anon_ri->add_child(inl);
@@ -174,7 +178,7 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
 
     if(!ret)
     {
-        ret = std::make_shared<render_item_inline_context>(src_el());
+        ret = src_el()->get_document()->make_node<render_item_inline_context>(src_el());
         ret->parent(parent());
         ret->children() = children();
         for (const auto &el: ret->children())
@@ -193,6 +197,33 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
     return ret;
 }
 
+bool litehtml::render_item_block::calc_render_width(const containing_block_context &containing_block_size, int& ret)
+{
+    if(is_root()) return false;
+
+    calc_outlines(containing_block_size.width);
+    containing_block_context self_size = calculate_containing_block_context(containing_block_size);
+
+    // min-width and max-width make _render() lay out the content again
+    if(self_size.min_width.type != containing_block_context::cbc_value_type_none ||
+       self_size.max_width.type != containing_block_context::cbc_value_type_none)
+    {
+        return false;
+    }
+
+    // the same width as _render() returns
+    if(self_size.width.type == containing_block_context::cbc_value_type_absolute)
+    {
+        ret = self_size.render_width;
+    } else if(!calc_content_width(self_size, ret))
+    {
+        return false;
+    }
+    m_pos.width = self_size.render_width;
+    ret += content_offset_width();
+    return true;
+}
+
 int litehtml::render_item_block::_render(int x, int y, const containing_block_context &containing_block_size, formatting_context* fmt_ctx, bool second_pass)
 {
     containing_block_context self_size = calculate_containing_block_context(containing_block_size);
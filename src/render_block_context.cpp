@@ -2,7 +2,7 @@
 #include "../include/litehtml/render_block_context.h"
 #include "../include/litehtml/document_litehtml.h"
 
-int litehtml::render_item_block_context::_render_content(int /*x*/, int /*y*/, bool second_pass, const containing_block_context &self_size, formatting_context* fmt_ctx)
+int litehtml::render_item_block_context::_render_content(int /*x*/, int y, bool second_pass, const containing_block_context &self_size, formatting_context* fmt_ctx)
 {
     element_position el_position;
 
@@ -11,6 +11,22 @@ int litehtml::render_item_block_context::_render_content(int /*x*/, int /*y*/, b
     int last_margin = 0;
     std::shared_ptr<render_item> last_margin_el;
     bool is_first = true;
+
+    // lazy layout: the children below the document's layout bottom get an estimated height
+    int defer_top = -1;
+    int laid_out = 0;
+    int laid_out_height = 0;
+    bool deferred = false;
+    document::ptr doc = src_el()->get_document();
+    if(doc->layout_bottom() >= 0)
+    {
+        init_lazy_layout(y);
+        if(m_can_defer)
+        {
+            defer_top = std::max(doc->layout_bottom() - m_doc_top, 0);
+        }
+    }
+
     for (const auto& el : m_children)
     {
         // we don't need to process absolute and fixed positioned element on the second pass
@@ -36,8 +52,22 @@ int litehtml::render_item_block_context::_render_content(int /*x*/, int /*y*/, b
                 {
                     el->render(0, child_top, self_size.new_width(min_rendered_width), fmt_ctx);
                 }
+            } else if(defer_top >= 0 && child_top >= defer_top)
+            {
+                // hidden until draw() or hit-testing reaches it
+                if(!deferred)
+                {
+                    doc->add_pending_layout(el);
+                    deferred = true;
+                }
+                el->skip(true);
+                child_top += laid_out ? laid_out_height / laid_out : el->src_el()->css().get_line_height();
+                last_margin = 0;
+                last_margin_el = nullptr;
+                is_first = false;
             } else
             {
+                el->skip(false);
                 child_top = fmt_ctx->get_cleared_top(el, child_top);
                 int child_x  = 0;
                 int child_width = self_size.render_width;
@@ -92,6 +122,8 @@ int litehtml::render_item_block_context::_render_content(int /*x*/, int /*y*/, b
                     ret_width = rw;
                 }
                 child_top += el->height();
+                laid_out++;
+                laid_out_height += el->height();
                 last_margin = el->get_margins().bottom;
                 last_margin_el = el;
                 is_first = false;
@@ -127,3 +159,49 @@ int litehtml::render_item_block_context::_render_content(int /*x*/, int /*y*/, b
 
     return ret_width;
 }
+
+void litehtml::render_item_block_context::init_lazy_layout(int y)
+{
+    auto parent_ctx = std::dynamic_pointer_cast<render_item_block_context>(parent());
+    m_doc_top = y + content_offset_top() + (parent_ctx ? parent_ctx->m_doc_top : 0);
+
+    // the width of the content-sized boxes depends on all children
+    const css_properties& css = src_el()->css();
+    m_can_defer = (parent_ctx ? parent_ctx->m_can_defer : src_el()->is_root()) &&
+                  (css.get_display() == display_block || css.get_display() == display_list_item) &&
+                  css.get_float() == float_none &&
+                  (css.get_position() == element_position_static || css.get_position() == element_position_relative);
+}
+
+bool litehtml::render_item_block_context::calc_content_width(const containing_block_context &self_size, int& ret)
+{
+    ret = 0;
+    for (const auto& el : m_children)
+    {
+        if(el->src_el()->css().get_float() != float_none) return false;
+        if(el->src_el()->css().get_display() == display_none) continue;
+
+        // positioned elements don't change the width of the block
+        element_position el_position = el->src_el()->css().get_position();
+        if(el_position == element_position_absolute || el_position == element_position_fixed) continue;
+
+        // without floats every child gets the whole line; its box is kept for the layout
+        position	pos		= el->pos();
+        margins		mrg		= el->get_margins();
+        margins		pad		= el->get_paddings();
+        margins		brd		= el->get_borders();
+        int rw = 0;
+        bool ok = el->calc_render_width(self_size.new_width(self_size.render_width), rw);
+        el->pos()			= pos;
+        el->get_margins()	= mrg;
+        el->get_paddings()	= pad;
+        el->get_borders()	= brd;
+        if(!ok) return false;
+
+        if (rw > ret)
+        {
+            ret = rw;
+        }
+    }
+    return true;
+}
@@ -33,8 +33,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_flex::init()
                 inlines.erase((not_space.base()), inlines.end());
             }
 
-            auto anon_el = std::make_shared<html_tag>(src_el());
-            auto anon_ri = std::make_shared<render_item_block>(anon_el);
+            auto anon_el = src_el()->get_document()->make_node<html_tag>(src_el());
+            auto anon_ri = src_el()->get_document()->make_node<render_item_block>(anon_el);
             for(const auto& inl : inlines)
             {
                 anon_ri->add_child(inl);
@@ -71,8 +71,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_flex::init()
             } else
             {
                 // Wrap inlines with anonymous block box
-                auto anon_el = std::make_shared<html_tag>(el->src_el());
-                auto anon_ri = std::make_shared<render_item_block>(anon_el);
+                auto anon_el = src_el()->get_document()->make_node<html_tag>(el->src_el());
+                auto anon_ri = src_el()->get_document()->make_node<render_item_block>(anon_el);
                 anon_ri->add_child(el->init());
                 anon_ri->parent(shared_from_this());
                 new_children.push_back(anon_ri->init());
@@ -7,6 +7,7 @@ int litehtml::render_item_inline_context::_render_content(int /*x*/, int /*y*/,
 {
     m_line_boxes.clear();
     m_max_line_width = 0;
+    m_vertical_shift = 0;
 
     white_space ws = src_el()->css().get_white_space();
     bool skip_spaces = false;
@@ -354,7 +355,8 @@ void litehtml::render_item_inline_context::apply_vertical_align()
     if(!m_line_boxes.empty())
     {
         int add = 0;
-        int content_height	= m_line_boxes.back()->bottom();
+        // the content can be shifted already if the layout came from the cache
+        int content_height	= m_line_boxes.back()->bottom() - m_vertical_shift;
 
         if(m_pos.height > content_height)
         {
@@ -372,12 +374,13 @@ void litehtml::render_item_inline_context::apply_vertical_align()
             }
         }
 
-        if(add)
+        if(add != m_vertical_shift)
         {
             for(auto & box : m_line_boxes)
             {
-                box->y_shift(add);
+                box->y_shift(add - m_vertical_shift);
             }
+            m_vertical_shift = add;
         }
     }
 }
@@ -400,3 +403,253 @@ int litehtml::render_item_inline_context::get_base_line()
     }
     return bl;
 }
+
+namespace
+{
+    using namespace litehtml;
+
+    // Line box item reduced to what the width of the line depends on
+    struct line_item_width
+    {
+        const render_item*			el;
+        line_box_item::element_type	type;
+        int							width;
+        int							min_width;
+    };
+
+    // Breaks the items into lines the same way as place_inline() and line_box do, but only sums
+    // up the widths of the lines. The lines are not shortened by floats.
+    class line_widths
+    {
+        std::vector<line_item_width>	m_items;	// items of the last line
+        bool							m_has_line	= false;
+        int								m_width		= 0;
+        int								m_right;
+        white_space						m_ws;
+    public:
+        int								max_width	= 0;	// the value of render_item_inline_context::m_max_line_width
+
+        line_widths(int right, white_space ws) : m_right(right), m_ws(ws) {}
+
+        void place(const line_item_width& item)
+        {
+            if(!m_has_line || !can_hold(item))
+            {
+                std::vector<line_item_width> items = finish(false);
+                m_items.clear();
+                m_width		= 0;
+                m_has_line	= true;
+                for(const auto& it : items)
+                {
+                    add_item(it);
+                }
+            }
+            add_item(item);
+        }
+
+        void finish_last()
+        {
+            if(m_has_line)
+            {
+                finish(true);
+            }
+        }
+
+    private:
+        const render_item* get_last_text_part() const
+        {
+            for(auto iter = m_items.rbegin(); iter != m_items.rend(); iter++)
+            {
+                if(iter->type == line_box_item::type_text_part) return iter->el;
+            }
+            return nullptr;
+        }
+
+        // all the items of the line are not skipped
+        bool is_empty() const
+        {
+            return get_last_text_part() == nullptr;
+        }
+
+        bool is_break_only() const
+        {
+            bool break_found = false;
+            for(const auto& it : m_items)
+            {
+                if(it.type == line_box_item::type_text_part)
+                {
+                    if(!it.el->src_el()->is_break()) return false;
+                    break_found = true;
+                }
+            }
+            return break_found;
+        }
+
+        bool have_last_space() const
+        {
+            auto last_el = get_last_text_part();
+            return last_el && (last_el->src_el()->is_white_space() || last_el->src_el()->is_break());
+        }
+
+        void add_item(const line_item_width& item)
+        {
+            if(item.type == line_box_item::type_text_part && item.el->src_el()->is_white_space())
+            {
+                if(is_empty() || have_last_space()) return;
+            }
+            m_items.push_back(item);
+            m_width += item.width;
+        }
+
+        bool can_hold(const line_item_width& item) const
+        {
+            if(item.type == line_box_item::type_text_part)
+            {
+                auto last_el = get_last_text_part();
+                if(last_el && last_el->src_el()->is_break()) return false;
+                if(item.el->src_el()->is_break()) return true;
+                if(m_ws == white_space_nowrap) return true;
+                if(m_width + item.width > m_right) return false;
+            }
+            return true;
+        }
+
+        // returns the items moved to the next line
+        std::vector<line_item_width> finish(bool last_box)
+        {
+            std::vector<line_item_width> ret;
+
+            if(!last_box)
+            {
+                while(!m_items.empty())
+                {
+                    const line_item_width& it = m_items.back();
+                    if(it.type == line_box_item::type_text_part)
+                    {
+                        if(!it.el->src_el()->is_break() && !it.el->src_el()->is_white_space()) break;
+                    } else if(it.type == line_box_item::type_inline_start)
+                    {
+                        ret.push_back(it);
+                    } else
+                    {
+                        break;
+                    }
+                    m_width -= it.width;
+                    m_items.pop_back();
+                }
+            } else
+            {
+                for(auto iter = m_items.rbegin(); iter != m_items.rend(); )
+                {
+                    if(iter->type == line_box_item::type_text_part)
+                    {
+                        if(!iter->el->src_el()->is_white_space()) break;
+                        m_width -= iter->width;
+                        iter = decltype(iter) (m_items.erase(std::next(iter).base()));
+                    } else
+                    {
+                        iter++;
+                    }
+                }
+            }
+
+            if(is_empty() || (last_box && is_break_only()))
+            {
+                return ret;
+            }
+
+            int min_width = 0;
+            std::vector<const render_item*> inlines;
+            for(const auto& it : m_items)
+            {
+                min_width += it.min_width;
+                if(it.type == line_box_item::type_inline_start || it.type == line_box_item::type_inline_continue)
+                {
+                    inlines.push_back(it.el);
+                } else if(it.type == line_box_item::type_inline_end && !inlines.empty())
+                {
+                    inlines.pop_back();
+                }
+            }
+            max_width = std::max(max_width, min_width);
+
+            // inline boxes that are not closed continue on the next line
+            ret.insert(ret.begin(), inlines.size(), line_item_width());
+            for(size_t i = 0; i < inlines.size(); i++)
+            {
+                ret[i] = {inlines[i], line_box_item::type_inline_continue, 0, 0};
+            }
+            return ret;
+        }
+    };
+}
+
+bool litehtml::render_item_inline_context::calc_content_width(const containing_block_context &self_size, int& ret)
+{
+    // the first line is not indented
+    if (src_el()->css().get_list_style_type() != list_style_type_none && src_el()->css().get_list_style_position() == list_style_position_inside)
+    {
+        return false;
+    }
+    if (src_el()->css().get_text_indent().val() != 0)
+    {
+        return false;
+    }
+
+    white_space ws = src_el()->css().get_white_space();
+    if (ws != white_space_normal && ws != white_space_nowrap)
+    {
+        return false;
+    }
+
+    line_widths lines(self_size.render_width, ws);
+    bool ok = true;
+    bool was_space = false;
+
+    go_inside_inline go_inside_inlines_selector;
+    inline_selector select_inlines;
+    elements_iterator inlines_iter(true, &go_inside_inlines_selector, &select_inlines);
+
+    inlines_iter.process(shared_from_this(), [&](const std::shared_ptr<render_item>& el, iterator_item_type item_type)
+        {
+            if (!ok) return;
+            switch (item_type)
+            {
+                case iterator_item_type_child:
+                    {
+                        // inline boxes and floats need the layout
+                        if (el->src_el()->css().get_display() != display_inline_text)
+                        {
+                            ok = false;
+                            return;
+                        }
+                        // the same spaces as in _render_content()
+                        if (el->src_el()->is_white_space())
+                        {
+                            if (was_space) return;
+                            was_space = true;
+                        } else
+                        {
+                            was_space = el->src_el()->is_break();
+                        }
+                        litehtml::size sz;
+                        el->src_el()->get_content_size(sz, self_size.render_width);
+                        lines.place({el.get(), line_box_item::type_text_part, sz.width + el->content_offset_width(), sz.width});
+                    }
+                    break;
+
+                case iterator_item_type_start_parent:
+                    lines.place({el.get(), line_box_item::type_inline_start, el->content_offset_left(), el->content_offset_left()});
+                    break;
+
+                case iterator_item_type_end_parent:
+                    lines.place({el.get(), line_box_item::type_inline_end, el->content_offset_right(), el->content_offset_right()});
+                    break;
+            }
+        });
+    if (!ok) return false;
+
+    lines.finish_last();
+    ret = lines.max_width;
+    return true;
+}
@@ -28,9 +28,89 @@ litehtml::render_item::render_item(std::shared_ptr<element>  _src_el) :
 }
 
 int litehtml::render_item::render(int x, int y, const containing_block_context& containing_block_size, formatting_context* fmt_ctx, bool second_pass)
+{
+    return cached_render(x, y, containing_block_size, fmt_ctx, second_pass, false);
+}
+
+int litehtml::render_item::measure(int x, int y, const containing_block_context& containing_block_size, formatting_context* fmt_ctx)
+{
+    return cached_render(x, y, containing_block_size, fmt_ctx, false, true);
+}
+
+int litehtml::render_item::min_content_width(const containing_block_context& containing_block_size, formatting_context* fmt_ctx)
+{
+    return content_width(containing_block_size.new_width(content_offset_width()), fmt_ctx);
+}
+
+int litehtml::render_item::max_content_width(const containing_block_context& containing_block_size, formatting_context* fmt_ctx)
+{
+    return content_width(containing_block_size, fmt_ctx);
+}
+
+int litehtml::render_item::content_width(const containing_block_context& containing_block_size, formatting_context* fmt_ctx)
+{
+    // outer floats can change the line widths of the content
+    if(src_el()->is_block_formatting_context() || !fmt_ctx)
+    {
+        if(!m_layout_cache)
+        {
+            m_layout_cache.reset(new layout_cache());
+        }
+        int generation = src_el()->get_document()->layout_generation();
+        const layout_cache::width_entry* cached = m_layout_cache->find_width(containing_block_size.width, generation);
+        if(cached)
+        {
+            calc_outlines(containing_block_size.width);
+            m_pos.width = cached->box_width;
+            return cached->ret;
+        }
+        int ret = 0;
+        if(calc_render_width(containing_block_size, ret))
+        {
+            layout_cache::width_entry& entry = m_layout_cache->store_width();
+            entry.cb_width		= containing_block_size.width;
+            entry.generation	= generation;
+            entry.ret			= ret;
+            entry.box_width		= m_pos.width;
+            return ret;
+        }
+    }
+    return measure(0, 0, containing_block_size, fmt_ctx);
+}
+
+int litehtml::render_item::cached_render(int x, int y, const containing_block_context& containing_block_size, formatting_context* fmt_ctx, bool second_pass, bool measure_only)
 {
     int ret;
 
+    // Content with its own formatting context has no effect outside of the item, so the
+    // same constraints give the same layout within one layout pass.
+    bool use_cache = src_el()->is_block_formatting_context() || !fmt_ctx;
+    layout_cache::entry* cached = nullptr;
+    int generation = 0;
+    if(use_cache)
+    {
+        if(!m_layout_cache)
+        {
+            m_layout_cache.reset(new layout_cache());
+        }
+        generation = src_el()->get_document()->layout_generation();
+        cached = m_layout_cache->find(containing_block_size, second_pass, generation);
+        // measure() needs only the box, the children keep the layout of the current entry
+        if(cached && (measure_only || m_layout_cache->is_current(cached)))
+        {
+            m_pos		= cached->pos;
+            m_pos.x		+= x;
+            m_pos.y		+= y;
+            m_margins	= cached->box_margins;
+            m_padding	= cached->box_padding;
+            m_borders	= cached->box_borders;
+            return cached->ret;
+        }
+    } else if(m_layout_cache)
+    {
+        m_layout_cache->invalidate_current();
+    }
+
     calc_outlines(containing_block_size.width);
 
     m_pos.clear();
@@ -55,6 +135,21 @@ int litehtml::render_item::render(int x, int y, const containing_block_context&
         ret = _render(x, y, containing_block_size, fmt_ctx, second_pass);
         fmt_ctx->pop_position(x + content_left, y + content_top);
     }
+
+    if(use_cache)
+    {
+        layout_cache::entry& entry = m_layout_cache->store(cached);
+        entry.cb_context	= containing_block_size;
+        entry.second_pass	= second_pass;
+        entry.generation	= generation;
+        entry.ret			= ret;
+        entry.pos			= m_pos;
+        entry.pos.x			-= x;
+        entry.pos.y			-= y;
+        entry.box_margins	= m_margins;
+        entry.box_padding	= m_padding;
+        entry.box_borders	= m_borders;
+    }
     return ret;
 }
 
@@ -255,6 +350,9 @@ bool litehtml::render_item::fetch_positioned()
 
     for(auto& el : m_children)
     {
+        // not laid out yet
+        if(el->skip()) continue;
+
         el_pos = el->src_el()->css().get_position();
         if (el_pos != element_position_static)
         {
@@ -987,6 +1085,44 @@ void litehtml::render_item::dump(litehtml::dumper& cout)
     cout.end_node();
 }
 
+void litehtml::render_item::set_needs_layout()
+{
+    if(!m_needs_layout)
+    {
+        m_needs_layout = true;
+        // the styles are inherited, the whole subtree is laid out again
+        drop_layout_caches();
+    }
+    // the size of the item changes the layout of the ancestors
+    for(auto el = parent(); el && !el->m_child_needs_layout; el = el->parent())
+    {
+        el->m_child_needs_layout = true;
+        el->m_layout_cache.reset();
+    }
+}
+
+void litehtml::render_item::drop_layout_caches()
+{
+    m_layout_cache.reset();
+    for(const auto& el : m_children)
+    {
+        el->drop_layout_caches();
+    }
+}
+
+void litehtml::render_item::clear_needs_layout()
+{
+    if(m_child_needs_layout)
+    {
+        for(const auto& el : m_children)
+        {
+            el->clear_needs_layout();
+        }
+    }
+    m_needs_layout			= false;
+    m_child_needs_layout	= false;
+}
+
 litehtml::position litehtml::render_item::get_placement() const
 {
     litehtml::position pos = m_pos;
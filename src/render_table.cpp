@@ -53,7 +53,7 @@ int litehtml::render_item_table::_render(int x, int y, const containing_block_co
             table_cell* cell = m_grid->cell(0, row);
             if (cell && cell->el)
             {
-                cell->min_width = cell->max_width = cell->el->render(0, 0, self_size.new_width(self_size.render_width - table_width_spacing), fmt_ctx);
+                cell->min_width = cell->max_width = cell->el->max_content_width(self_size.new_width(self_size.render_width - table_width_spacing), fmt_ctx);
                 cell->el->pos().width = cell->min_width - cell->el->content_offset_left() -
                         cell->el->content_offset_right();
             }
@@ -71,7 +71,7 @@ int litehtml::render_item_table::_render(int x, int y, const containing_block_co
                     if (!m_grid->column(col).css_width.is_predefined() && m_grid->column(col).css_width.units() != css_units_percentage)
                     {
                         int css_w = m_grid->column(col).css_width.calc_percent(self_size.width);
-                        int el_w = cell->el->render(0, 0, self_size.new_width(css_w),fmt_ctx);
+                        int el_w = cell->el->max_content_width(self_size.new_width(css_w), fmt_ctx);
                         cell->min_width = cell->max_width = std::max(css_w, el_w);
                         cell->el->pos().width = cell->min_width - cell->el->content_offset_left() -
                                 cell->el->content_offset_right();
@@ -79,9 +79,9 @@ int litehtml::render_item_table::_render(int x, int y, const containing_block_co
                     else
                     {
                         // calculate minimum content width
-                        cell->min_width = cell->el->render(0, 0, self_size.new_width(cell->el->content_offset_width()), fmt_ctx);
+                        cell->min_width = cell->el->min_content_width(self_size, fmt_ctx);
                         // calculate maximum content width
-                        cell->max_width = cell->el->render(0, 0, self_size.new_width(self_size.render_width - table_width_spacing), fmt_ctx);
+                        cell->max_width = cell->el->max_content_width(self_size.new_width(self_size.render_width - table_width_spacing), fmt_ctx);
                     }
                 }
             }
@@ -1,5 +1,7 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/string_id.h"
+#include <atomic>
+#include <stdexcept>
 
 #ifndef LITEHTML_NO_THREADS
     #include <mutex>
@@ -12,41 +14,158 @@
 namespace litehtml
 {
 
-static std::map<string, string_id> map;
-static std::vector<string> array;
-
-static int init()
+// Interned strings.
+// Lookups never lock: the strings are kept in append-only chunks and indexed by an
+// open-addressing hash table whose slots are published atomically. Only inserting
+// a new string takes the mutex.
+class string_table
 {
-    string_vector names;
-    split_string(initial_string_ids, names, ",");
-    for (auto& name : names)
+    static const unsigned chunk_bits = 10;
+    static const unsigned chunk_size = 1 << chunk_bits;
+    static const unsigned max_chunks = 4096;
+
+    // slot: (hash << 32) | (id + 1), zero is an empty slot
+    struct hash_table
+    {
+        explicit hash_table(unsigned capacity) : mask(capacity - 1), slots(new std::atomic<uint64_t>[capacity])
+        {
+            for(unsigned i = 0; i < capacity; i++) slots[i].store(0, std::memory_order_relaxed);
+        }
+
+        unsigned								mask;
+        std::unique_ptr<std::atomic<uint64_t>[]>	slots;
+        std::unique_ptr<hash_table>				prev;	// kept alive for concurrent readers
+    };
+
+    std::atomic<string*>		m_chunks[max_chunks];
+    std::atomic<hash_table*>	m_table;
+    unsigned					m_size = 0;
+public:
+    string_table()
+    {
+        for(auto& chunk : m_chunks) chunk.store(nullptr, std::memory_order_relaxed);
+        m_table.store(new hash_table(4096), std::memory_order_relaxed);
+
+        #define STRING_ID(id, name) insert(name, hash(name, sizeof(name) - 1));
+        LITEHTML_STRING_IDS(STRING_ID)
+        #undef STRING_ID
+    }
+
+    ~string_table()
+    {
+        delete m_table.load(std::memory_order_relaxed);
+        for(auto& chunk : m_chunks) delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    string_id get_id(const string& str)
+    {
+        uint32_t h = hash(str.data(), str.size());
+        int id = find(m_table.load(std::memory_order_acquire), str, h);
+        if(id >= 0) return (string_id) id;
+
+        lock_guard;
+        // another thread may have inserted it meanwhile
+        id = find(m_table.load(std::memory_order_acquire), str, h);
+        if(id >= 0) return (string_id) id;
+        return insert(str, h);
+    }
+
+    const string& get_string(string_id id) const
     {
-        trim(name);
-        name = name.substr(1, name.size() - 2);				// _border_color_ -> border_color
-        std::replace(name.begin(), name.end(), '_', '-');	// border_color   -> border-color
-        _id(name);  // this will create association _border_color_ <-> "border-color"
+        return m_chunks[id >> chunk_bits].load(std::memory_order_acquire)[id & (chunk_size - 1)];
     }
-    return 0;
+
+private:
+    static uint32_t hash(const char* str, size_t len)
+    {
+        // FNV-1a
+        uint32_t h = 2166136261u;
+        for(size_t i = 0; i < len; i++)
+        {
+            h ^= (unsigned char) str[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    int find(const hash_table* table, const string& str, uint32_t h) const
+    {
+        for(unsigned i = h & table->mask; ; i = (i + 1) & table->mask)
+        {
+            uint64_t slot = table->slots[i].load(std::memory_order_acquire);
+            if(!slot) return -1;
+            if((uint32_t) (slot >> 32) == h)
+            {
+                auto id = (string_id) ((uint32_t) slot - 1);
+                if(get_string(id) == str) return id;
+            }
+        }
+    }
+
+    static void put(hash_table* table, uint64_t slot)
+    {
+        for(unsigned i = (unsigned) (slot >> 32) & table->mask; ; i = (i + 1) & table->mask)
+        {
+            if(!table->slots[i].load(std::memory_order_relaxed))
+            {
+                table->slots[i].store(slot, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    // must be called with the mutex held
+    string_id insert(const string& str, uint32_t h)
+    {
+        unsigned id = m_size;
+        unsigned chunk = id >> chunk_bits;
+        if(chunk >= max_chunks) throw std::length_error("litehtml: too many interned strings");
+
+        string* storage = m_chunks[chunk].load(std::memory_order_relaxed);
+        if(!storage)
+        {
+            storage = new string[chunk_size];
+            m_chunks[chunk].store(storage, std::memory_order_release);
+        }
+        storage[id & (chunk_size - 1)] = str;
+        m_size++;
+
+        // keep the load factor below 1/2
+        hash_table* table = m_table.load(std::memory_order_relaxed);
+        if(m_size * 2 > table->mask + 1)
+        {
+            auto grown = new hash_table((table->mask + 1) * 2);
+            for(unsigned i = 0; i <= table->mask; i++)
+            {
+                uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+                if(slot) put(grown, slot);
+            }
+            grown->prev.reset(table);
+            m_table.store(grown, std::memory_order_release);
+            table = grown;
+        }
+        put(table, ((uint64_t) h << 32) | (id + 1));
+        return (string_id) id;
+    }
+};
+
+static string_table& strings()
+{
+    static string_table table;
+    return table;
 }
-static int dummy = init();
 
 const string_id empty_id = _id("");
 const string_id star_id = _id("*");
 
 string_id _id(const string& str)
 {
-    lock_guard;
-    auto it = map.find(str);
-    if (it != map.end()) return it->second;
-    // else: str not found, add it to the array and the map
-    array.push_back(str);
-    return map[str] = (string_id)(array.size() - 1);
+    return strings().get_id(str);
 }
 
 const string& _s(string_id id)
 {
-    lock_guard;
-    return array[id];
+    return strings().get_string(id);
 }
 
 } // namespace litehtml
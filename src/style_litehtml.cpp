@@ -1,88 +1,97 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/style_litehtml.h"
+#include "../include/litehtml/css_tokenizer.h"
+#include "../include/litehtml/keywords.h"
 
 namespace litehtml
 {
 
-std::map<string_id, string> style::m_valid_values =
+std::map<string_id, const keyword_table*> style::m_valid_values =
 {
-    { _display_, style_display_strings },
-    { _visibility_, visibility_strings },
-    { _position_, element_position_strings },
-    { _float_, element_float_strings },
-    { _clear_, element_clear_strings },
-    { _overflow_, overflow_strings },
-    { _box_sizing_, box_sizing_strings },
-
-    { _text_align_, text_align_strings },
-    { _vertical_align_, vertical_align_strings },
-    { _text_transform_, text_transform_strings },
-    { _white_space_, white_space_strings },
-
-    { _font_style_, font_style_strings },
-    { _font_variant_, font_variant_strings },
-    { _font_weight_, font_weight_strings },
-
-    { _list_style_type_, list_style_type_strings },
-    { _list_style_position_, list_style_position_strings },
-
-    { _border_left_style_, border_style_strings },
-    { _border_right_style_, border_style_strings },
-    { _border_top_style_, border_style_strings },
-    { _border_bottom_style_, border_style_strings },
-    { _border_collapse_, border_collapse_strings },
+    { _display_, &style_display_keywords() },
+    { _visibility_, &visibility_keywords() },
+    { _position_, &element_position_keywords() },
+    { _float_, &element_float_keywords() },
+    { _clear_, &element_clear_keywords() },
+    { _overflow_, &overflow_keywords() },
+    { _box_sizing_, &box_sizing_keywords() },
+
+    { _text_align_, &text_align_keywords() },
+    { _vertical_align_, &vertical_align_keywords() },
+    { _text_transform_, &text_transform_keywords() },
+    { _white_space_, &white_space_keywords() },
+
+    { _font_style_, &font_style_keywords() },
+    { _font_variant_, &font_variant_keywords() },
+    { _font_weight_, &font_weight_keywords() },
+
+    { _list_style_type_, &list_style_type_keywords() },
+    { _list_style_position_, &list_style_position_keywords() },
+
+    { _border_left_style_, &border_style_keywords() },
+    { _border_right_style_, &border_style_keywords() },
+    { _border_top_style_, &border_style_keywords() },
+    { _border_bottom_style_, &border_style_keywords() },
+    { _border_collapse_, &border_collapse_keywords() },
 
     // these 4 properties are comma-separated lists of keywords, see parse_keyword_comma_list
-    { _background_attachment_, background_attachment_strings },
-    { _background_repeat_, background_repeat_strings },
-    { _background_clip_, background_box_strings },
-    { _background_origin_, background_box_strings },
-
-    { _flex_direction_, flex_direction_strings },
-    { _flex_wrap_, flex_wrap_strings },
-    { _justify_content_, flex_justify_content_strings },
-    { _align_items_, flex_align_items_strings },
-    { _align_content_, flex_align_content_strings },
-    { _align_self_, flex_align_self_strings },
-
-    { _caption_side_, caption_side_strings },
+    { _background_attachment_, &background_attachment_keywords() },
+    { _background_repeat_, &background_repeat_keywords() },
+    { _background_clip_, &background_box_keywords() },
+    { _background_origin_, &background_box_keywords() },
+
+    { _flex_direction_, &flex_direction_keywords() },
+    { _flex_wrap_, &flex_wrap_keywords() },
+    { _justify_content_, &flex_justify_content_keywords() },
+    { _align_items_, &flex_align_items_keywords() },
+    { _align_content_, &flex_align_content_keywords() },
+    { _align_self_, &flex_align_self_keywords() },
+
+    { _caption_side_, &caption_side_keywords() },
 };
 
-void style::parse(const string& txt, const string& baseurl, document_container* container)
+void style::parse(const char* begin, const char* end, const string& baseurl, document_container* container)
 {
-    std::vector<string> properties;
-    split_string(txt, properties, ";", "", "\"'");
-
-    for(const auto & property : properties)
+    css_tokenizer tok(begin, end);
+    while(!tok.eof())
     {
-        parse_property(property, baseurl, container);
+        const char* start = tok.pos();
+        tok.skip_until(";");
+        parse_property(start, tok.pos(), baseurl, container);
+        if(!tok.eof())
+        {
+            tok.next();
+        }
     }
 }
 
-void style::parse_property(const string& txt, const string& baseurl, document_container* container)
+void style::parse_property(const char* begin, const char* end, const string& baseurl, document_container* container)
 {
-    string::size_type pos = txt.find_first_of(':');
-    if(pos != string::npos)
+    css_tokenizer tok(begin, end);
+    if(tok.skip_until(":"))
     {
-        string name = txt.substr(0, pos);
-        string val	= txt.substr(pos + 1);
+        string name;
+        css_tokenizer::get_text(begin, tok.pos(), name);
+        lcase(name);
+
+        const char* val_start = tok.pos() + 1;
+        // "!important" is the last top-level '!' of the value
+        const char* excl = css_tokenizer::find_last(val_start, end, '!');
+        bool important = false;
+        if(excl != end)
+        {
+            string prio;
+            css_tokenizer::get_text(excl + 1, end, prio);
+            lcase(prio);
+            important = prio == "important";
+        }
 
-        trim(name); lcase(name);
-        trim(val);
+        string val;
+        css_tokenizer::get_text(val_start, excl, val);
 
         if(!name.empty() && !val.empty())
         {
-            string_vector vals;
-            split_string(val, vals, "!");
-            if(vals.size() == 1)
-            {
-                add_property(_id(name), val, baseurl, false, container);
-            } else if(vals.size() > 1)
-            {
-                trim(vals[0]);
-                lcase(vals[1]);
-                add_property(_id(name), vals[0], baseurl, vals[1] == "important", container);
-            }
+            add_property(_id(name), val, baseurl, important, container);
         }
     }
 }
@@ -134,7 +143,7 @@ void style::add_property(string_id name, const string& val, const string& baseur
 
     case _caption_side_:
 
-        idx = value_index(val, m_valid_values[name]);
+        idx = m_valid_values[name]->find(val);
         if (idx >= 0)
         {
             add_parsed_property(name, property_value(idx, important));
@@ -182,7 +191,7 @@ void style::add_property(string_id name, const string& val, const string& baseur
         break;
 
     case _font_size_:
-        length.fromString(val, font_size_strings, -1);
+        length.fromString(val, font_size_keywords(), -1);
         add_parsed_property(name, property_value(length, important));
         break;
 
@@ -224,7 +233,7 @@ void style::add_property(string_id name, const string& val, const string& baseur
         split_string(val, tokens, " ", "", "(");
         for (const auto& token : tokens)
         {
-            int idx2 = value_index(token, border_style_strings);
+            int idx2 = border_style_keywords().find(token);
             if (idx2 >= 0)
             {
                 property_value style(idx2, important);
@@ -234,7 +243,7 @@ void style::add_property(string_id name, const string& val, const string& baseur
                 add_parsed_property(_border_bottom_style_,	style);
             }
             else if (t_isdigit(token[0]) || token[0] == '.' ||
-                value_in_list(token, border_width_strings))
+                border_width_keywords().contains(token))
             {
                 property_value width(parse_border_width(token), important);
                 add_parsed_property(_border_left_width_,	width);
@@ -264,13 +273,13 @@ void style::add_property(string_id name, const string& val, const string& baseur
         split_string(val, tokens, " ", "", "(");
         for (const auto& token : tokens)
         {
-            int idx2 = value_index(token, border_style_strings);
+            int idx2 = border_style_keywords().find(token);
             if (idx2 >= 0)
             {
                 add_parsed_property(_id(_s(name) + "-style"), property_value(idx2, important));
             }
             else if (t_isdigit(token[0]) || token[0] == '.' ||
-                value_in_list(token, border_width_strings))
+                border_width_keywords().contains(token))
             {
                 property_value width(parse_border_width(token), important);
                 add_parsed_property(_id(_s(name) + "-width"), width);
@@ -433,14 +442,14 @@ void style::add_property(string_id name, const string& val, const string& baseur
         split_string(val, tokens, " ", "", "(");
         for (const auto& token : tokens)
         {
-            int idx2 = value_index(token, list_style_type_strings);
+            int idx2 = list_style_type_keywords().find(token);
             if (idx2 >= 0)
             {
                 add_parsed_property(_list_style_type_, property_value(idx2, important));
             }
             else
             {
-                idx2 = value_index(token, list_style_position_strings);
+                idx2 = list_style_position_keywords().find(token);
                 if (idx2 >= 0)
                 {
                     add_parsed_property(_list_style_position_, property_value(idx2, important));
@@ -509,11 +518,11 @@ void style::add_property(string_id name, const string& val, const string& baseur
         for (const auto& tok : tokens)
         {
             int idx2;
-            if ((idx2 = value_index(tok, flex_direction_strings)) >= 0)
+            if ((idx2 = flex_direction_keywords().find(tok)) >= 0)
             {
                 add_parsed_property(_flex_direction_, property_value(idx2, important));
             }
-            else if ((idx2 = value_index(tok, flex_wrap_strings)) >= 0)
+            else if ((idx2 = flex_wrap_keywords().find(tok)) >= 0)
             {
                 add_parsed_property(_flex_wrap_, property_value(idx2, important));
             }
@@ -532,7 +541,7 @@ void style::add_property(string_id name, const string& val, const string& baseur
         break;
 
     case _flex_basis_:
-        length.fromString(val, flex_basis_strings, -1);
+        length.fromString(val, flex_basis_keywords(), -1);
         add_parsed_property(_flex_basis_, property_value(length, important));
         break;
 
@@ -550,7 +559,7 @@ css_length style::parse_border_width(const string& str)
     }
     else
     {
-        int idx = value_index(str, border_width_strings);
+        int idx = border_width_keywords().find(str);
         if (idx >= 0)
         {
             len.set_value(border_width_values[idx], css_units_px);
@@ -670,17 +679,17 @@ bool style::parse_one_background(const string& val, document_container* containe
             css::parse_css_url(token, url);
             bg.m_image = { url };
             image_found = true;
-        } else if( (idx = value_index(token, background_repeat_strings)) >= 0 )
+        } else if( (idx = background_repeat_keywords().find(token)) >= 0 )
         {
             if (repeat_found) return false;
             bg.m_repeat = { idx };
             repeat_found = true;
-        } else if( (idx = value_index(token, background_attachment_strings)) >= 0 )
+        } else if( (idx = background_attachment_keywords().find(token)) >= 0 )
         {
             if (attachment_found) return false;
             bg.m_attachment = { idx };
             attachment_found = true;
-        } else if( (idx = value_index(token, background_box_strings)) >= 0 )
+        } else if( (idx = background_box_keywords().find(token)) >= 0 )
         {
             if(!origin_found)
             {
@@ -692,7 +701,7 @@ bool style::parse_one_background(const string& val, document_container* containe
                 bg.m_clip = { idx };
                 clip_found = true;
             }
-        } else if(	value_in_list(token, background_position_strings) ||
+        } else if(	background_position_keywords().contains(token) ||
                     token.find('/') != std::string::npos ||
                     t_isdigit(token[0]) ||
                     token[0] == '+'	||
@@ -759,7 +768,7 @@ void style::parse_keyword_comma_list(string_id name, const string& val, bool imp
     for (auto& token : tokens)
     {
         trim(token);
-        int idx = value_index(token, m_valid_values[name]);
+        int idx = m_valid_values[name]->find(token);
         if (idx == -1) return;
         vec.push_back(idx);
     }
@@ -904,10 +913,10 @@ bool style::parse_one_background_size(const string& val, css_size& size)
         return false;
     }
 
-    size.width.fromString(res[0], background_size_strings);
+    size.width.fromString(res[0], background_size_keywords());
     if (res.size() > 1)
     {
-        size.height.fromString(res[1], background_size_strings);
+        size.height.fromString(res[1], background_size_keywords());
     }
     else
     {
@@ -949,7 +958,7 @@ void style::parse_font(const string& val, bool important)
             continue;
         }
 
-        if((idx = value_index(token, font_style_strings)) >= 0)
+        if((idx = font_style_keywords().find(token)) >= 0)
         {
             if(idx == 0)
             {
@@ -960,20 +969,20 @@ void style::parse_font(const string& val, bool important)
             {
                 add_parsed_property(_font_style_,	property_value(idx,		important));
             }
-        } else if((idx = value_index(token, font_weight_strings)) >= 0)
+        } else if((idx = font_weight_keywords().find(token)) >= 0)
         {
             add_parsed_property(_font_weight_, property_value(idx, important));
-        } else if((idx = value_index(token, font_variant_strings)) >= 0)
+        } else if((idx = font_variant_keywords().find(token)) >= 0)
         {
             add_parsed_property(_font_variant_, property_value(idx, important));
         }
         else if(t_isdigit(token[0]) || token[0] == '.' ||
-            value_in_list(token, font_size_strings) || token.find('/') != std::string::npos)
+            font_size_keywords().contains(token) || token.find('/') != std::string::npos)
         {
             string_vector szlh;
             split_string(token, szlh, "/");
 
-            auto size = css_length::from_string(szlh[0], font_size_strings, -1);
+            auto size = css_length::from_string(szlh[0], font_size_keywords(), -1);
             add_parsed_property(_font_size_, property_value(size, important));
 
             if(szlh.size() == 2)
@@ -1035,7 +1044,7 @@ void style::parse_flex(const string& val, bool important)
         {
             float grow = t_strtof(tokens[0]);
             float shrink = t_strtof(tokens[1]);
-            auto basis = css_length::from_string(tokens[2], flex_basis_strings, -1);
+            auto basis = css_length::from_string(tokens[2], flex_basis_keywords(), -1);
 
             add_parsed_property(_flex_grow_,	property_value(grow, important));
             add_parsed_property(_flex_shrink_,	property_value(shrink, important));
@@ -1053,7 +1062,7 @@ void style::parse_flex(const string& val, bool important)
             }
             else
             {
-                auto basis = css_length::from_string(tokens[1], flex_basis_strings, -1);
+                auto basis = css_length::from_string(tokens[1], flex_basis_keywords(), -1);
                 add_parsed_property(_flex_basis_, property_value(basis, important));
             }
         }
@@ -1072,7 +1081,7 @@ void style::parse_flex(const string& val, bool important)
             }
             else
             {
-                auto basis = css_length::from_string(tokens[0], flex_basis_strings, -1);
+                auto basis = css_length::from_string(tokens[0], flex_basis_keywords(), -1);
                 add_parsed_property(_flex_basis_, property_value(basis, important));
             }
         }
@@ -1081,8 +1090,8 @@ void style::parse_flex(const string& val, bool important)
 
 void style::add_parsed_property( string_id name, const property_value& propval )
 {
-    auto prop = m_properties.find(name);
-    if (prop != m_properties.end())
+    auto prop = m_properties.lower_bound(name);
+    if (prop != m_properties.end() && prop->first == name)
     {
         if (!prop->second.m_important || (propval.m_important && prop->second.m_important))
         {
@@ -1091,7 +1100,7 @@ void style::add_parsed_property( string_id name, const property_value& propval )
     }
     else
     {
-        m_properties[name] = propval;
+        m_properties.items().insert(prop, props_map::value_type(name, propval));
     }
 }
 
@@ -1109,10 +1118,45 @@ void style::remove_property( string_id name, bool important )
 
 void style::combine(const style& src)
 {
-    for (const auto& property : src.m_properties)
+    if (m_properties.empty())
     {
-        add_parsed_property(property.first, property.second);
+        m_properties = src.m_properties;
+        return;
+    }
+
+    // both sides are sorted by id: cascade src into this style with one linear merge
+    const props_map::container& theirs = src.m_properties.items();
+    props_map::container& ours = m_properties.items();
+    props_map::container merged;
+    merged.reserve(ours.size() + theirs.size());
+
+    auto our = ours.begin();
+    auto their = theirs.begin();
+    while (our != ours.end() || their != theirs.end())
+    {
+        if (their == theirs.end() || (our != ours.end() && our->first < their->first))
+        {
+            merged.push_back(std::move(*our++));
+        }
+        else if (our == ours.end() || their->first < our->first)
+        {
+            merged.push_back(*their++);
+        }
+        else
+        {
+            if (!our->second.m_important || their->second.m_important)
+            {
+                merged.push_back(*their);
+            }
+            else
+            {
+                merged.push_back(std::move(*our));
+            }
+            ++our;
+            ++their;
+        }
     }
+    ours.swap(merged);
 }
 
 const property_value& style::get_property(string_id name) const
@@ -1144,16 +1188,29 @@ void style::subst_vars_(string& str, const element* el)
 
 void style::subst_vars(const element* el)
 {
-    for (auto& prop : m_properties)
+    // re-adding properties may insert into m_properties, so collect them first
+    std::vector<std::pair<string_id, property_value>> vars;
+    for (const auto& prop : m_properties)
     {
         if (prop.second.m_type == prop_type_var)
         {
-            subst_vars_(prop.second.m_string, el);
-            // re-adding the same property
-            // if it is a custom property it will be readded as a string (currently it is prop_type_var)
-            // if it is a standard css property it will be parsed and properly added as typed property
-            add_property(prop.first, prop.second.m_string, "", prop.second.m_important, el->get_document()->container());
+            vars.push_back(prop);
+        }
+    }
+    for (const auto& prop : vars)
+    {
+        string str = prop.second.get_string();
+        bool important = prop.second.m_important;
+        subst_vars_(str, el);
+        auto it = m_properties.find(prop.first);
+        if (it != m_properties.end() && it->second.m_type == prop_type_var)
+        {
+            it->second = property_value(str, important, prop_type_var);
         }
+        // re-adding the same property
+        // if it is a custom property it will be readded as a string (currently it is prop_type_var)
+        // if it is a standard css property it will be parsed and properly added as typed property
+        add_property(prop.first, str, "", important, el->get_document()->container());
     }
 }
 
@@ -1,81 +1,111 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/stylesheet.h"
+#include "../include/litehtml/css_tokenizer.h"
 #include <algorithm>
 #include "../include/litehtml/document_litehtml.h"
 
+#ifndef LITEHTML_NO_THREADS
+    #include <mutex>
+    static std::mutex cache_mutex;
+    #define lock_guard std::lock_guard<std::mutex> lock(cache_mutex)
+#else
+    #define lock_guard
+#endif
+
+namespace
+{
+    struct css_cache_entry
+    {
+        uint64_t						hash;
+        litehtml::string				text;
+        litehtml::string				baseurl;
+        litehtml::string				media;
+        litehtml::document_container*	container;
+        litehtml::css::const_ptr		sheet;
+        uint64_t						last_used;
+    };
+
+    const size_t max_cached_stylesheets = 32;
+
+    std::vector<css_cache_entry>	css_cache;
+    uint64_t						css_cache_clock = 0;
+
+    uint64_t css_hash(const char* str, size_t len)
+    {
+        // FNV-1a
+        uint64_t h = 14695981039346656037ull;
+        for(size_t i = 0; i < len; i++)
+        {
+            h ^= (unsigned char) str[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+}
+
 
 void litehtml::css::parse_stylesheet(const char* str, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
 {
-    string text = str;
-
-	// remove comments
-	string::size_type c_start = text.find("/*");
-	while(c_start != string::npos)
-	{
-		string::size_type c_end = text.find("*/", c_start + 2);
-		if(c_end == string::npos)
-		{
-			text.erase(c_start);
-			break;
-		}
-		text.erase(c_start, c_end - c_start + 2);
-		c_start = text.find("/*");
-	}
-
-    string::size_type pos = text.find_first_not_of(" \n\r\t");
-    while(pos != string::npos)
-    {
-        while(pos != string::npos && text[pos] == '@')
-        {
-            string::size_type sPos = pos;
-            pos = text.find_first_of("{;", pos);
-            if(pos != string::npos && text[pos] == '{')
+    if(str)
+    {
+        parse_rules(str, str + strlen(str), baseurl, doc, media);
+    }
+}
+
+void litehtml::css::parse_rules(const char* begin, const char* end, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+{
+    css_tokenizer tok(begin, end);
+    string selectors;
+
+    while(true)
+    {
+        tok.skip_whitespace();
+        if(tok.eof())
+        {
+            break;
+        }
+
+        if(tok.peek() == '@')
+        {
+            const char* rule_start = tok.pos();
+            bool closed = tok.skip_until("{;");
+            if(closed && tok.peek() == '{')
             {
-                pos = find_close_bracket(text, pos, '{', '}');
+                closed = tok.skip_block();
             }
-            if(pos != string::npos)
+            if(closed)
             {
-                parse_atrule(text.substr(sPos, pos - sPos + 1), baseurl, doc, media);
-            } else
-            {
-                parse_atrule(text.substr(sPos), baseurl, doc, media);
-            }
-
-            if(pos != string::npos)
-            {
-                pos = text.find_first_not_of(" \n\r\t", pos + 1);
+                tok.next();
             }
+            parse_atrule(rule_start, tok.pos(), baseurl, doc, media);
+            continue;
         }
 
-        if(pos == string::npos)
+        const char* selectors_start = tok.pos();
+        if(!tok.skip_until("{"))
         {
             break;
         }
-
-        string::size_type style_start	= text.find('{', pos);
-        string::size_type style_end	= text.find('}', pos);
-        if(style_start != string::npos && style_end != string::npos)
+        const char* selectors_end = tok.pos();
+        tok.next();
+        const char* style_start = tok.pos();
+        if(!tok.skip_until("}"))
         {
-            auto str_style = text.substr(style_start + 1, style_end - style_start - 1);
-            style::ptr style = std::make_shared<litehtml::style>();
-            style->add(str_style, baseurl ? baseurl : "", doc->container());
-
-            parse_selectors(text.substr(pos, style_start - pos), style, media);
-
-            if(media && doc)
-            {
-                doc->add_media_list(media);
-            }
+            break;
+        }
+        const char* style_end = tok.pos();
+        tok.next();
 
-            pos = style_end + 1;
-        } else
+        style::ptr style = std::make_shared<litehtml::style>();
+        css_tokenizer::get_text(selectors_start, selectors_end, selectors);
+        if(parse_selectors(selectors, style, media))
         {
-            pos = string::npos;
+            style->add(style_start, style_end, baseurl ? baseurl : "", doc ? doc->container() : nullptr);
         }
 
-        if(pos != string::npos)
+        if(media && doc)
         {
-            pos = text.find_first_not_of(" \n\r\t", pos);
+            doc->add_media_list(media);
         }
     }
 }
@@ -122,6 +152,7 @@ bool litehtml::css::parse_selectors( const string& txt, const style::ptr& styles
         if(new_selector->parse(token))
         {
             new_selector->calc_specificity();
+            new_selector->calc_ancestor_hashes();
             add_selector(new_selector);
             added_something = true;
         }
@@ -130,24 +161,120 @@ bool litehtml::css::parse_selectors( const string& txt, const style::ptr& styles
     return added_something;
 }
 
+void litehtml::css::add_selectors(const css& src)
+{
+    // m_order of shared selectors is left untouched: sort_selectors keeps the order of
+    // equally specific selectors, and selectors are appended in document order
+    m_selectors.insert(m_selectors.end(), src.m_selectors.begin(), src.m_selectors.end());
+    m_indexed = false;
+}
+
 void litehtml::css::sort_selectors()
 {
-    std::sort(m_selectors.begin(), m_selectors.end(),
+    std::stable_sort(m_selectors.begin(), m_selectors.end(),
          [](const css_selector::ptr& v1, const css_selector::ptr& v2)
          {
-             return (*v1) < (*v2);
+             return v1->m_specificity < v2->m_specificity;
          }
     );
+    build_index();
 }
 
-void litehtml::css::parse_atrule(const string& text, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+void litehtml::css::build_index()
 {
-    if(text.substr(0, 7) == "@import")
+    clear_index();
+    for(int i = 0; i < (int) m_selectors.size(); i++)
     {
-        int sPos = 7;
+        const css_element_selector& right = m_selectors[i]->m_right;
+
+        // The most selective key of the rightmost compound selector wins: #id, then .class, then tag.
+        const css_attribute_selector* cls = nullptr;
+        const css_attribute_selector* id = nullptr;
+        for(const auto& attr : right.m_attrs)
+        {
+            if(attr.type == select_id && !id)
+            {
+                id = &attr;
+            } else if(attr.type == select_class && !cls)
+            {
+                cls = &attr;
+            }
+        }
+
+        if(id)
+        {
+            m_id_index[id->name].push_back(i);
+        } else if(cls)
+        {
+            m_class_index[cls->name].push_back(i);
+        } else if(right.m_tag != star_id)
+        {
+            m_tag_index[right.m_tag].push_back(i);
+        } else
+        {
+            m_universal_index.push_back(i);
+        }
+    }
+    m_indexed = true;
+}
+
+void litehtml::css::clear_index()
+{
+    m_id_index.clear();
+    m_class_index.clear();
+    m_tag_index.clear();
+    m_universal_index.clear();
+    m_indexed = false;
+}
+
+void litehtml::css::get_candidates(string_id tag, string_id id, const std::vector<string_id>& classes, std::vector<int>& res) const
+{
+    res.clear();
+    if(!m_indexed)
+    {
+        // stylesheet was not sorted yet: every selector is a candidate
+        res.reserve(m_selectors.size());
+        for(int i = 0; i < (int) m_selectors.size(); i++)
+        {
+            res.push_back(i);
+        }
+        return;
+    }
+
+    auto add_bucket = [&res](const selectors_index& index, string_id key)
+        {
+            auto bucket = index.find(key);
+            if(bucket != index.end())
+            {
+                res.insert(res.end(), bucket->second.begin(), bucket->second.end());
+            }
+        };
+
+    res.insert(res.end(), m_universal_index.begin(), m_universal_index.end());
+    add_bucket(m_tag_index, tag);
+    if(id != empty_id)
+    {
+        add_bucket(m_id_index, id);
+    }
+    for(auto cls : classes)
+    {
+        add_bucket(m_class_index, cls);
+    }
+
+    // merge buckets back into specificity/order sequence; duplicated classes give duplicated positions
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+}
+
+void litehtml::css::parse_atrule(const char* begin, const char* end, const char* baseurl, const std::shared_ptr<document>& doc, const media_query_list::ptr& media)
+{
+    size_t len = end - begin;
+    if(len >= 7 && !strncmp(begin, "@import", 7))
+    {
+        m_has_imports = true;
         string iStr;
-        iStr = text.substr(sPos);
-        if(iStr[iStr.length() - 1] == ';')
+        css_tokenizer::get_text(begin + 7, end, iStr);
+        if(!iStr.empty() && iStr[iStr.length() - 1] == ';')
         {
             iStr.erase(iStr.length() - 1);
         }
@@ -200,26 +327,93 @@ void litehtml::css::parse_atrule(const string& text, const char* baseurl, const
                 }
             }
         }
-    } else if(text.substr(0, 6) == "@media")
+    } else if(len >= 6 && !strncmp(begin, "@media", 6))
     {
-        string::size_type b1 = text.find_first_of('{');
-        string::size_type b2 = text.find_last_of('}');
-        if(b1 != string::npos)
+        css_tokenizer tok(begin, end);
+        if(tok.skip_until("{"))
         {
-            string media_type = text.substr(6, b1 - 6);
-            trim(media_type);
+            const char* b1 = tok.pos();
+            string media_type;
+            css_tokenizer::get_text(begin + 6, b1, media_type);
             media_query_list::ptr new_media = media_query_list::create_from_string(media_type, doc);
 
-            string media_style;
-            if(b2 != string::npos)
-            {
-                media_style = text.substr(b1 + 1, b2 - b1 - 1);
-            } else
+            const char* b2 = css_tokenizer::find_last(b1 + 1, end, '}');
+            parse_rules(b1 + 1, b2, baseurl, doc, new_media);
+        }
+    }
+}
+
+litehtml::css::const_ptr litehtml::css::get_cached(const char* str, const char* baseurl, const char* media, const std::shared_ptr<document>& doc)
+{
+    if(!str) str = "";
+    if(!baseurl) baseurl = "";
+    if(!media) media = "";
+    size_t len = strlen(str);
+    uint64_t hash = css_hash(str, len);
+    document_container* container = doc ? doc->container() : nullptr;
+
+    {
+        lock_guard;
+        for(auto& entry : css_cache)
+        {
+            if(entry.hash == hash && entry.container == container && entry.text.size() == len &&
+               entry.baseurl == baseurl && entry.media == media && !memcmp(entry.text.data(), str, len))
             {
-                media_style = text.substr(b1 + 1);
+                entry.last_used = ++css_cache_clock;
+                return entry.sheet;
             }
-
-            parse_stylesheet(media_style.c_str(), baseurl, doc, new_media);
         }
     }
+
+    // parse without holding the lock; if another thread did the same, both results are equal
+    auto sheet = std::make_shared<css>();
+    media_query_list::ptr media_list;
+    if(*media)
+    {
+        media_list = media_query_list::create_from_string(media, doc);
+    }
+    sheet->parse_stylesheet(str, baseurl, doc, media_list);
+    sheet->sort_selectors();
+    if(sheet->m_has_imports)
+    {
+        // imported sheets are loaded through the container and may change between documents
+        return sheet;
+    }
+
+    lock_guard;
+    if(css_cache.size() >= max_cached_stylesheets)
+    {
+        auto lru = std::min_element(css_cache.begin(), css_cache.end(),
+            [](const css_cache_entry& a, const css_cache_entry& b) { return a.last_used < b.last_used; });
+        css_cache.erase(lru);
+    }
+    css_cache.push_back({hash, string(str, len), baseurl, media, container, sheet, ++css_cache_clock});
+    return sheet;
+}
+
+void litehtml::css::clear_cache()
+{
+    lock_guard;
+    css_cache.clear();
+}
+
+void litehtml::css::clear_cache(const document_container* container)
+{
+    lock_guard;
+    css_cache.erase(std::remove_if(css_cache.begin(), css_cache.end(),
+        [container](const css_cache_entry& entry) { return entry.container == container; }), css_cache.end());
+}
+
+litehtml::css::const_ptr litehtml::css::default_master()
+{
+    // parsed without a document: the master stylesheet has no media queries, imports or
+    // container specific colors
+    static const const_ptr sheet = []
+        {
+            auto ret = std::make_shared<css>();
+            ret->parse_stylesheet(master_css, nullptr, nullptr, nullptr);
+            ret->sort_selectors();
+            return ret;
+        }();
+    return sheet;
 }
@@ -1,6 +1,9 @@
 #include "../include/litehtml/html.h"
 #include "../include/litehtml/web_color.h"
+#include "../include/litehtml/keywords.h"
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 const litehtml::web_color litehtml::web_color::transparent = web_color(0, 0, 0, 0);
 const litehtml::web_color litehtml::web_color::black       = web_color(0, 0, 0, 255);
@@ -158,73 +161,191 @@ litehtml::def_color litehtml::g_def_colors[] =
 };
 
 
-litehtml::web_color litehtml::web_color::from_string(const string& _str, document_container* callback)
+namespace
 {
-    auto str = _str.c_str();
-    if(!str[0])
-    {
-        return web_color(0, 0, 0);
-    }
-    if(str[0] == '#')
+    using namespace litehtml;
+
+    // Named colors keyed by their lowercased names
+    class named_colors
     {
-        string red;
-        string green;
-        string blue;
-        if(strlen(str + 1) == 3)
+        string					m_names;
+        keyword_table			m_table;
+        std::vector<web_color>	m_colors;
+
+        static string lowercase_names()
         {
-            red		+= str[1];
-            red		+= str[1];
-            green	+= str[2];
-            green	+= str[2];
-            blue	+= str[3];
-            blue	+= str[3];
-        } else if(strlen(str + 1) == 6)
+            string names;
+            for(int i = 0; g_def_colors[i].name; i++)
+            {
+                if(i) names += ';';
+                for(const char* c = g_def_colors[i].name; *c; c++)
+                {
+                    names += (char) t_tolower(*c);
+                }
+            }
+            return names;
+        }
+    public:
+        named_colors() : m_names(lowercase_names()), m_table(m_names.c_str())
         {
-            red		+= str[1];
-            red		+= str[2];
-            green	+= str[3];
-            green	+= str[4];
-            blue	+= str[5];
-            blue	+= str[6];
+            for(int i = 0; g_def_colors[i].name; i++)
+            {
+                m_colors.push_back(web_color::from_string(g_def_colors[i].rgb, nullptr));
+            }
         }
-        char* sss = nullptr;
-        web_color clr;
-        clr.red		= (byte) strtol(red.c_str(),	&sss, 16);
-        clr.green	= (byte) strtol(green.c_str(),	&sss, 16);
-        clr.blue	= (byte) strtol(blue.c_str(),	&sss, 16);
-        return clr;
-    } else if(!strncmp(str, "rgb", 3))
+
+        // returns the index in g_def_colors or -1
+        int find(const char* name, size_t len) const
+        {
+            char buf[32];
+            if(len >= sizeof(buf)) return -1;
+            for(size_t i = 0; i < len; i++)
+            {
+                buf[i] = (char) t_tolower(name[i]);
+            }
+            return m_table.find(tstring_view(buf, len));
+        }
+
+        const web_color& color(int idx) const { return m_colors[idx]; }
+    };
+
+    const named_colors& get_named_colors()
     {
-        string s = str;
+        static const named_colors colors;
+        return colors;
+    }
 
-        string::size_type pos = s.find_first_of('(');
-        if(pos != string::npos)
+    inline int hex_digit(char c)
+    {
+        if(c >= '0' && c <= '9') return c - '0';
+        c = (char) t_tolower(c);
+        if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    // #rgb, #rgba, #rrggbb and #rrggbbaa
+    web_color parse_hex(const char* str, size_t len)
+    {
+        int digits[8];
+        if(len != 3 && len != 4 && len != 6 && len != 8) return web_color(0, 0, 0);
+        for(size_t i = 0; i < len; i++)
         {
-            s.erase(s.begin(), s.begin() + pos + 1);
+            digits[i] = hex_digit(str[i]);
+            if(digits[i] < 0) return web_color(0, 0, 0);
         }
-        pos = s.find_last_of(')');
-        if(pos != string::npos)
+        byte c[4] = {0, 0, 0, 255};
+        if(len <= 4)
+        {
+            for(size_t i = 0; i < len; i++) c[i] = (byte) (digits[i] * 17);
+        } else
         {
-            s.erase(s.begin() + pos, s.end());
+            for(size_t i = 0; i < len / 2; i++) c[i] = (byte) (digits[i * 2] * 16 + digits[i * 2 + 1]);
         }
+        return web_color(c[0], c[1], c[2], c[3]);
+    }
 
-        std::vector<string> tokens;
-        split_string(s, tokens, ", \t");
+    // Reads the next argument of rgb() or hsl(), skipping separators before it
+    // and units such as "deg" after it.
+    bool next_number(const char*& p, float& val, bool& percent)
+    {
+        while(*p == ',' || *p == '/' || *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+        char* end = nullptr;
+        val = (float) t_strtod(p, &end);
+        if(end == p) return false;
+        p = end;
+        percent = *p == '%';
+        if(percent) p++;
+        while(t_isalpha(*p)) p++;
+        return true;
+    }
 
+    inline byte to_byte(float val)
+    {
+        if(val <= 0) return 0;
+        if(val >= 255) return 255;
+        return (byte) (val + 0.5f);
+    }
+
+    float hue_to_rgb(float m1, float m2, float h)
+    {
+        if(h < 0) h += 1;
+        if(h > 1) h -= 1;
+        if(h * 6 < 1) return m1 + (m2 - m1) * h * 6;
+        if(h * 2 < 1) return m2;
+        if(h * 3 < 2) return m1 + (m2 - m1) * (2.0f / 3 - h) * 6;
+        return m1;
+    }
+
+    // rgb(), rgba(), hsl() and hsla() with comma or space separated arguments
+    web_color parse_function(const char* str, bool hsl)
+    {
         web_color clr;
+        const char* p = strchr(str, '(');
+        if(!p) return clr;
+        p++;
 
-        if(tokens.size() >= 1)	clr.red		= (byte) atoi(tokens[0].c_str());
-        if(tokens.size() >= 2)	clr.green	= (byte) atoi(tokens[1].c_str());
-        if(tokens.size() >= 3)	clr.blue	= (byte) atoi(tokens[2].c_str());
-        if(tokens.size() >= 4)	clr.alpha	= (byte) (t_strtod(tokens[3].c_str(), nullptr) * 255.0);
+        float val[4] = {0, 0, 0, 1};
+        bool percent[4] = {false, false, false, false};
+        int count = 0;
+        while(count < 4 && next_number(p, val[count], percent[count])) count++;
 
+        if(hsl)
+        {
+            float h = std::fmod(val[0], 360.0f) / 360;
+            if(h < 0) h += 1;
+            float s = std::min(std::max(val[1] / 100, 0.0f), 1.0f);
+            float l = std::min(std::max(val[2] / 100, 0.0f), 1.0f);
+            float m2 = l <= 0.5f ? l * (s + 1) : l + s - l * s;
+            float m1 = l * 2 - m2;
+            clr.red		= to_byte(hue_to_rgb(m1, m2, h + 1.0f / 3) * 255);
+            clr.green	= to_byte(hue_to_rgb(m1, m2, h) * 255);
+            clr.blue	= to_byte(hue_to_rgb(m1, m2, h - 1.0f / 3) * 255);
+        } else
+        {
+            clr.red		= to_byte(percent[0] ? val[0] * 2.55f : val[0]);
+            clr.green	= to_byte(percent[1] ? val[1] * 2.55f : val[1]);
+            clr.blue	= to_byte(percent[2] ? val[2] * 2.55f : val[2]);
+        }
+        if(count >= 4)
+        {
+            float alpha = percent[3] ? val[3] / 100 : val[3];
+            clr.alpha = (byte) (std::min(std::max(alpha, 0.0f), 1.0f) * 255.0);
+        }
         return clr;
-    } else
+    }
+}
+
+litehtml::web_color litehtml::web_color::from_string(const string& str, document_container* callback)
+{
+    if(str.empty())
+    {
+        return web_color(0, 0, 0);
+    }
+    if(str[0] == '#')
+    {
+        return parse_hex(str.c_str() + 1, str.length() - 1);
+    }
+    if(!t_strncasecmp(str.c_str(), "rgb", 3))
+    {
+        return parse_function(str.c_str(), false);
+    }
+    if(!t_strncasecmp(str.c_str(), "hsl", 3))
+    {
+        return parse_function(str.c_str(), true);
+    }
+
+    const named_colors& named = get_named_colors();
+    int idx = named.find(str.c_str(), str.length());
+    if(idx >= 0)
+    {
+        return named.color(idx);
+    }
+    if(callback)
     {
-        string rgb = resolve_name(str, callback);
+        string rgb = callback->resolve_color(str);
         if(!rgb.empty())
         {
-            return from_string(rgb.c_str(), callback);
+            return from_string(rgb, callback);
         }
     }
     return web_color(0, 0, 0);
@@ -232,12 +353,10 @@ litehtml::web_color litehtml::web_color::from_string(const string& _str, documen
 
 litehtml::string litehtml::web_color::resolve_name(const string& name, document_container* callback)
 {
-    for(int i=0; g_def_colors[i].name; i++)
+    int idx = get_named_colors().find(name.c_str(), name.length());
+    if(idx >= 0)
     {
-        if(!t_strcasecmp(name.c_str(), g_def_colors[i].name))
-        {
-            return g_def_colors[i].rgb;
-        }
+        return g_def_colors[idx].rgb;
     }
     if (callback)
     {
@@ -249,14 +368,22 @@ litehtml::string litehtml::web_color::resolve_name(const string& name, document_
 
 bool litehtml::web_color::is_color(const string& str, document_container* callback)
 {
-    if (!t_strncasecmp(str.c_str(), "rgb", 3) || str[0] == '#')
+    if (str.empty())
     {
-        return true;
+        return false;
     }
-    if (t_isalpha(str[0]) && resolve_name(str, callback) != "")
+    if (str[0] == '#' || !t_strncasecmp(str.c_str(), "rgb", 3) || !t_strncasecmp(str.c_str(), "hsl", 3))
     {
         return true;
     }
+    if (t_isalpha(str[0]))
+    {
+        if (get_named_colors().find(str.c_str(), str.length()) >= 0)
+        {
+            return true;
+        }
+        return callback && !callback->resolve_color(str).empty();
+    }
     return false;
 }
 
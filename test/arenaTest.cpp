@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "litehtml.h"
+#include "../containers/test/test_container.h"
+
+using namespace litehtml;
+
+static const char* arena_html =
+  "<style>.h:hover { padding-left: 50px }</style>"
+  "<div class=h>hover me</div>"
+  "<p>paragraph <b>bold</b> text</p>"
+  "<ul><li>list item</li></ul>"
+  "<div style='float: left; width: 100px'>floating text</div>"
+  "<table><tr><td>cell</td><td>another cell</td></tr></table>";
+
+static void compare_layout(const element::ptr& a, const element::ptr& b)
+{
+  position pos_a = a->get_placement();
+  position pos_b = b->get_placement();
+  EXPECT_EQ(pos_a.x, pos_b.x);
+  EXPECT_EQ(pos_a.y, pos_b.y);
+  EXPECT_EQ(pos_a.width, pos_b.width);
+  EXPECT_EQ(pos_a.height, pos_b.height);
+
+  ASSERT_EQ(a->children().size(), b->children().size());
+  auto child_b = b->children().begin();
+  for (const auto& child_a : a->children()) compare_layout(child_a, *child_b++);
+}
+
+TEST(ArenaTest, Layout) {
+  // the nodes allocated from the arena are laid out as the heap allocated ones
+  test_container container(800, 600, "");
+  document::ptr heap = document::createFromString(arena_html, &container);
+  document::ptr arena = document::createFromString(arena_html, &container, master_css, "", true);
+
+  EXPECT_EQ(arena->render(800), heap->render(800));
+  EXPECT_EQ(arena->height(), heap->height());
+  compare_layout(arena->root(), heap->root());
+
+  // restyle and lay out again
+  position pos = arena->root()->select_one(".h")->get_placement();
+  position::vector redraw_boxes;
+  EXPECT_TRUE(arena->on_mouse_over(pos.x + 1, pos.y + 1, pos.x + 1, pos.y + 1, redraw_boxes));
+  EXPECT_TRUE(heap->on_mouse_over(pos.x + 1, pos.y + 1, pos.x + 1, pos.y + 1, redraw_boxes));
+  EXPECT_EQ(arena->render(800), heap->render(800));
+  EXPECT_EQ(arena->height(), heap->height());
+  compare_layout(arena->root(), heap->root());
+
+  // the arena is released with the last node, not with the document
+  element::ptr p = arena->root()->select_one("p");
+  arena.reset();
+  string text;
+  p->get_text(text);
+  EXPECT_EQ(text, "paragraph bold text");
+}
+
+TEST(ArenaTest, GumboOutput) {
+  // the DOM keeps the decoded text and attributes after the Gumbo output is released
+  const char* html =
+    "<p id=text title='a &amp; b' data-x=\"&lt;1&gt;\" lang=fr>x &lt; caf&eacute; &#x263A;</p>";
+  test_container container(800, 600, "");
+  for (bool use_arena : {false, true})
+  {
+    // nothing may point into the source either
+    string source = html;
+    document::ptr doc = document::createFromString(source.c_str(), &container, master_css, "", use_arena);
+    source.assign(source.size(), '-');
+    element::ptr p = doc->root()->select_one("#text");
+    ASSERT_TRUE(p);
+    EXPECT_STREQ(p->get_attr("title"), "a & b");
+    EXPECT_STREQ(p->get_attr("data-x"), "<1>");
+    EXPECT_STREQ(p->get_attr("lang"), "fr");
+    string text;
+    p->get_text(text);
+    EXPECT_EQ(text, "x < caf\xC3\xA9 \xE2\x98\xBA");
+
+    // every text node keeps its own copy: single-character, entity-decoded and multi-byte ones
+    std::vector<string> words;
+    for (const auto& child : p->children())
+    {
+      string word;
+      child->get_text(word);
+      words.push_back(word);
+    }
+    std::vector<string> expected = {"x", " ", "<", " ", "caf\xC3\xA9", " ", "\xE2\x98\xBA"};
+    EXPECT_EQ(words, expected);
+  }
+}
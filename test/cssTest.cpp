@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
 #include <assert.h>
+#include <new>
 #include "litehtml.h"
+#include "litehtml/keywords.h"
+#include "../containers/test/test_container.h"
 using namespace litehtml;
 
 TEST(CSSTest, Url) {
@@ -64,6 +67,31 @@ TEST(CSSTest, LengthParse) {
   assert(length.predef() == 0);
   assert(length.val() == 123);
   assert(length.units() == css_units_px);
+
+  length.fromString("-1.5em");
+  EXPECT_FALSE(length.is_predefined());
+  EXPECT_EQ(length.val(), -1.5f);
+  EXPECT_EQ(length.units(), css_units_em);
+
+  length.fromString("50%");
+  EXPECT_EQ(length.val(), 50);
+  EXPECT_EQ(length.units(), css_units_percentage);
+
+  length.fromString("2REM");
+  EXPECT_EQ(length.units(), css_units_rem);
+
+  length.fromString("10vmax");
+  EXPECT_EQ(length.units(), css_units_vmax);
+
+  length.fromString("10furlong");
+  EXPECT_EQ(length.val(), 10);
+  EXPECT_EQ(length.units(), css_units_none);
+
+  // a slice of a longer string
+  const char* str = "12dpcm 34";
+  length.fromString(tstring_view(str, 6));
+  EXPECT_EQ(length.val(), 12);
+  EXPECT_EQ(length.units(), css_units_dpcm);
 }
 
 TEST(CSSTest, ElementSelectorParse) {
@@ -162,3 +190,237 @@ TEST(CSSTest, ElementSelectorParse) {
   EXPECT_TRUE(selector.m_tag == _id("tag"));
   EXPECT_TRUE(selector.m_attrs.size() == 2);
 }
+
+TEST(CSSTest, SelectorIndex) {
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString("", &container);
+
+  css sheet;
+  sheet.parse_stylesheet("#main {color:red} .a {color:red} div {color:red} * {color:red} "
+                         "div.b {color:red} span#main.a {color:red} .b .a {color:red}", "", doc, nullptr);
+  sheet.sort_selectors();
+
+  std::vector<int> candidates;
+  sheet.get_candidates(_div_, empty_id, {}, candidates);
+  EXPECT_TRUE(candidates.size() == 2); // div, *
+
+  sheet.get_candidates(_div_, empty_id, {_id("a"), _id("b"), _id("a")}, candidates);
+  EXPECT_TRUE(candidates.size() == 5); // div, *, .a, div.b, .b .a
+
+  sheet.get_candidates(_span_, _id("main"), {}, candidates);
+  EXPECT_TRUE(candidates.size() == 3); // #main, span#main.a, *
+
+  // candidates come back in specificity/order sequence
+  for (size_t i = 1; i < candidates.size(); i++)
+    EXPECT_TRUE(*sheet.selectors()[candidates[i - 1]] < *sheet.selectors()[candidates[i]]);
+}
+
+TEST(CSSTest, AncestorFilter) {
+  css_selector selector;
+  selector.parse(".a > div#b span");
+  selector.calc_ancestor_hashes();
+  EXPECT_TRUE(selector.m_ancestor_hashes.size() == 3); // #b, div, .a
+
+  ancestor_filter filter;
+  EXPECT_FALSE(filter.may_match(selector));
+
+  filter.add(ancestor_filter::class_hash(_id("a")));
+  filter.add(ancestor_filter::tag_hash(_div_));
+  EXPECT_FALSE(filter.may_match(selector));
+
+  filter.add(ancestor_filter::id_hash(_id("b")));
+  EXPECT_TRUE(filter.may_match(selector));
+
+  filter.remove(ancestor_filter::class_hash(_id("a")));
+  EXPECT_FALSE(filter.may_match(selector));
+
+  // sibling compounds are not ancestors
+  selector.parse(".a + span");
+  selector.calc_ancestor_hashes();
+  EXPECT_TRUE(selector.m_ancestor_hashes.empty());
+}
+
+TEST(CSSTest, ParseStylesheet) {
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString("", &container);
+
+  css sheet;
+  sheet.parse_stylesheet("/* header */ div /* c */ , p {color: red /* c */; content: \"}; !\"}"
+                         "@media print { a {color:green} }"
+                         ".a {background-image: url(data:image/png;base64,AAA); width: 10px ! IMPORTANT}"
+                         "span {height: 5px", "", doc, nullptr);
+  ASSERT_EQ(sheet.selectors().size(), 4u);
+
+  const style::ptr& first = sheet.selectors()[0]->m_style;
+  EXPECT_EQ(first->get_property(_color_).m_type, prop_type_color);
+  EXPECT_EQ(first->get_property(_content_).get_string(), "\"}; !\"");
+  EXPECT_EQ(sheet.selectors()[1]->m_style, first);
+
+  EXPECT_TRUE(sheet.selectors()[2]->m_media_query != nullptr);
+
+  const style::ptr& third = sheet.selectors()[3]->m_style;
+  EXPECT_EQ(third->get_property(_background_image_).m_type, prop_type_string_vector);
+  EXPECT_TRUE(third->get_property(_width_).m_important);
+}
+
+TEST(CSSTest, StylesheetCache) {
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString("", &container);
+
+  const char* text = "div {color:red} @media all { p {color:green} }";
+  css::const_ptr sheet = css::get_cached(text, "", "", doc);
+  EXPECT_EQ(sheet->selectors().size(), 2u);
+  EXPECT_EQ(css::get_cached(text, "", "", doc), sheet);
+  EXPECT_NE(css::get_cached(text, "http://example.com/", "", doc), sheet);
+  EXPECT_NE(css::get_cached(text, "", "print", doc), sheet);
+
+  // media state is kept by each document
+  document::ptr doc2 = document::createFromString("", &container);
+  const css_selector::ptr& sel = sheet->selectors()[1];
+  sel->add_media_to_doc(doc2.get());
+  EXPECT_FALSE(sel->is_media_valid(doc2.get()));
+  doc2->media_changed();
+  EXPECT_TRUE(sel->is_media_valid(doc2.get()));
+  EXPECT_FALSE(sel->is_media_valid(doc.get()));
+
+  css::clear_cache();
+  EXPECT_NE(css::get_cached(text, "", "", doc), sheet);
+}
+
+TEST(CSSTest, StylesheetCacheContainerLifetime) {
+  // a container allocated at the address of a destroyed one must not get its stylesheets
+  const char* text = "p { color: red }";
+  alignas(test_container) unsigned char storage[sizeof(test_container)];
+
+  test_container* container = new (storage) test_container(800, 600, "");
+  css::const_ptr sheet = css::get_cached(text, "", "", document::createFromString("", container));
+  EXPECT_EQ(css::get_cached(text, "", "", document::createFromString("", container)), sheet);
+  container->~test_container();
+
+  container = new (storage) test_container(800, 600, "");
+  EXPECT_NE(css::get_cached(text, "", "", document::createFromString("", container)), sheet);
+  container->~test_container();
+}
+
+TEST(CSSTest, DefaultMaster) {
+  css::const_ptr master = css::default_master();
+  EXPECT_FALSE(master->selectors().empty());
+  EXPECT_EQ(css::default_master(), master);
+}
+
+TEST(CSSTest, KeywordTable) {
+  // every keyword maps to the same index as value_index
+#define CHECK_KEYWORDS(name)                                                 \
+  {                                                                          \
+    string_vector items;                                                     \
+    split_string(name##_strings, items, ";");                                \
+    for (const auto& item : items)                                           \
+      EXPECT_EQ(name##_keywords().find(item), value_index(item, name##_strings)) << item; \
+  }
+  LITEHTML_KEYWORD_LISTS(CHECK_KEYWORDS)
+#undef CHECK_KEYWORDS
+
+  EXPECT_EQ(style_display_keywords().find("inline-block"), display_inline_block);
+  EXPECT_EQ(style_display_keywords().find("inline-"), -1);
+  EXPECT_EQ(style_display_keywords().find(""), -1);
+  EXPECT_EQ(font_weight_keywords().find("bolder", 7), font_weight_bolder);
+  EXPECT_EQ(font_weight_keywords().find("heavy", 7), 7);
+  EXPECT_TRUE(border_width_keywords().contains("thin"));
+  EXPECT_FALSE(border_width_keywords().contains("Thin"));
+}
+
+TEST(CSSTest, StyleSharing) {
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString(
+      "<div><p>a</p><p style='color:red'>b</p><p>c</p><p class=x>d</p></div>"
+      "<style>.x {color:blue}</style>", &container);
+  elements_list paras = doc->root()->select_all("p");
+  ASSERT_EQ(paras.size(), 4u);
+  auto it = paras.begin();
+  web_color def = (*it++)->css().get_color();
+  EXPECT_EQ((*it++)->css().get_color(), web_color(255, 0, 0));
+  EXPECT_EQ((*it++)->css().get_color(), def);
+  EXPECT_EQ((*it++)->css().get_color(), web_color(0, 0, 255));
+}
+
+TEST(CSSTest, SharedComputedStyle) {
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString("<p>a b</p><p>c</p>", &container);
+  elements_list paras = doc->root()->select_all("p");
+  ASSERT_EQ(paras.size(), 2u);
+  element::ptr p1 = paras.front(), p2 = paras.back();
+  EXPECT_EQ(&p1->css(), &p2->css());
+
+  // text runs of one parent share their style
+  const auto& words = p1->children();
+  ASSERT_GE(words.size(), 2u);
+  EXPECT_EQ(&words.front()->css(), &words.back()->css());
+
+  // changing a shared style copies it first
+  p2->css_w().set_display(display_none);
+  EXPECT_NE(&p1->css(), &p2->css());
+  EXPECT_EQ(p1->css().get_display(), display_block);
+  EXPECT_EQ(p2->css().get_display(), display_none);
+}
+
+TEST(CSSTest, Cascade) {
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString(
+      "<div style='color:#ff0000;text-align:center;padding-left:5px;display:flex'>"
+      "<span style='padding-left:inherit;border-top-color:#00ff00;flex-basis:10px'>x</span></div>", &container);
+  element::ptr div = doc->root()->select_one("div");
+  element::ptr span = doc->root()->select_one("span");
+  ASSERT_TRUE(div && span);
+
+  // inherited properties come from the parent, the others start from their initial values
+  EXPECT_EQ(span->css().get_color(), web_color(255, 0, 0));
+  EXPECT_EQ(span->css().get_text_align(), text_align_center);
+  EXPECT_EQ(span->css().get_padding().left.val(), 5);
+  EXPECT_TRUE(span->css().get_width().is_predefined());
+
+  // border colors default to the element's color
+  EXPECT_EQ(span->css().get_borders().top.color, web_color(0, 255, 0));
+  EXPECT_EQ(span->css().get_borders().left.color, web_color(255, 0, 0));
+
+  EXPECT_EQ(span->css().get_flex_basis().val(), 10);
+}
+
+class counting_tag : public html_tag
+{
+  int& m_calls;
+public:
+  counting_tag(const document::ptr& doc, int& calls) : html_tag(doc), m_calls(calls) {}
+
+  void apply_stylesheet(const litehtml::css& stylesheet) override
+  {
+    m_calls++;
+    html_tag::apply_stylesheet(stylesheet);
+  }
+};
+
+class counting_container : public test_container
+{
+public:
+  int calls = 0;
+
+  counting_container() : test_container(800, 600, "") {}
+
+  element::ptr create_element(const char* tag_name, const string_map&, const document::ptr& doc) override
+  {
+    if (!strcmp(tag_name, "x-count")) return std::make_shared<counting_tag>(doc, calls);
+    return nullptr;
+  }
+};
+
+TEST(CSSTest, ApplyStylesheetOverride) {
+  // the elements overriding apply_stylesheet(const css&) are called for every stylesheet
+  counting_container container;
+  document::ptr doc = document::createFromString(
+      "<style>div .a x-count { color: #ff0000 }</style>"
+      "<div><x-count class=a><x-count>text</x-count></x-count></div>", &container);
+  element::ptr inner = doc->root()->select_one("x-count x-count");
+  ASSERT_TRUE(inner);
+  EXPECT_GT(container.calls, 0);
+  EXPECT_EQ(container.calls % 2, 0);
+  EXPECT_EQ(inner->css().get_color(), web_color(255, 0, 0));
+}
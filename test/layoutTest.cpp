@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include "litehtml.h"
+#include "litehtml/render_item.h"
+#include "../containers/test/test_container.h"
+#include "../containers/test/Bitmap.h"
+
+using namespace litehtml;
+
+static string nested_tables(int depth)
+{
+  string html;
+  for (int i = 0; i < depth; i++) html += "<table><tr><td>cell text</td><td>";
+  html += "inner";
+  for (int i = 0; i < depth; i++) html += "</td></tr></table>";
+  return html;
+}
+
+TEST(LayoutTest, NestedTables) {
+  // each table renders its cells several times; without the layout cache this takes seconds
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString(nested_tables(12).c_str(), &container);
+  int width = doc->render(800);
+  int height = doc->height();
+  EXPECT_GT(width, 0);
+  EXPECT_GT(height, 0);
+
+  // the cache is dropped between renders, the same input gives the same layout
+  EXPECT_EQ(doc->render(800), width);
+  EXPECT_EQ(doc->height(), height);
+}
+
+static void find_cells(const std::shared_ptr<render_item>& ri, std::vector<std::shared_ptr<render_item>>& cells)
+{
+  if (ri->src_el()->css().get_display() == display_table_cell) cells.push_back(ri);
+  for (const auto& child : ri->children()) find_cells(child, cells);
+}
+
+TEST(LayoutTest, ContentWidth) {
+  // the widths calculated without a layout must match the widths returned by the layout
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString(
+    "<table><tr>"
+    "<td>short</td>"
+    "<td>a few words  in a   cell</td>"
+    "<td>text <b>bold <i>and italic</i></b> text</td>"
+    "<td>line<br>break<br><br>twice </td>"
+    "<td><span style='padding: 0 7px; border-left: 3px solid'>padded inline</span> text</td>"
+    "<td style='white-space: nowrap'>no wrap at all <b>here</b></td>"
+    "<td style='width: 40px'>fixed width</td>"
+    "<td><div>block</div><div>another block with text</div></td>"
+    "<td><img width=20 height=20> image</td>"
+    "</tr></table>", &container);
+  doc->render(800);
+
+  std::vector<std::shared_ptr<render_item>> cells;
+  find_cells(doc->root_render_item(), cells);
+  ASSERT_EQ(cells.size(), 9u);
+
+  containing_block_context cb;
+  for (const auto& cell : cells)
+  {
+    int min_width = cell->min_content_width(cb, nullptr);
+    EXPECT_EQ(min_width, cell->measure(0, 0, cb.new_width(cell->content_offset_width()), nullptr));
+    for (int width : {0, 30, 60, 100, 1000})
+    {
+      int max_width = cell->max_content_width(cb.new_width(width), nullptr);
+      EXPECT_EQ(max_width, cell->measure(0, 0, cb.new_width(width), nullptr)) << "width " << width;
+      EXPECT_EQ(cell->max_content_width(cb.new_width(width), nullptr), max_width);
+    }
+  }
+}
+
+TEST(LayoutTest, RenderChanges) {
+  // laying out only the restyled items gives the same result as the full layout
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString(
+    "<style>.c:hover { padding-top: 30px; padding-left: 100px }</style>"
+    "<div class=c>hover me <span style='display: inline-block'>inline block</span></div>"
+    "<div style='float: left'>floating text</div>"
+    "<p>text below</p>"
+    "<table><tr><td>table cell</td></tr></table>", &container);
+  doc->render(800);
+
+  element::ptr el = doc->root()->select_one(".c");
+  element::ptr text = doc->root()->select_one("p");
+  ASSERT_TRUE(el && text);
+  position pos = el->get_placement();
+  position::vector redraw_boxes;
+  ASSERT_TRUE(doc->on_mouse_over(pos.x + 1, pos.y + 1, pos.x + 1, pos.y + 1, redraw_boxes));
+
+  int width = doc->render_changes(800);
+  int height = doc->height();
+  position el_pos = el->get_placement();
+  position text_pos = text->get_placement();
+  EXPECT_NE(el_pos.x, pos.x);
+
+  EXPECT_EQ(doc->render(800), width);
+  EXPECT_EQ(doc->height(), height);
+  EXPECT_EQ(el->get_placement().x, el_pos.x);
+  EXPECT_EQ(el->get_placement().width, el_pos.width);
+  EXPECT_EQ(text->get_placement().y, text_pos.y);
+
+  // nothing changed since the last layout
+  EXPECT_EQ(doc->render_changes(800), width);
+  EXPECT_EQ(doc->height(), height);
+}
+
+static int count_deferred(const std::shared_ptr<render_item>& body)
+{
+  int ret = 0;
+  for (const auto& child : body->children()) if (child->skip()) ret++;
+  return ret;
+}
+
+TEST(LayoutTest, LazyLayout) {
+  // the blocks below the viewport are laid out when they are drawn or hit-tested
+  string html = "<div style='height: 100px'>header</div>";
+  for (int i = 0; i < 2000; i++) html += "<div>line " + std::to_string(i) + "<br>second line</div>";
+
+  test_container container(800, 600, "");
+  document::ptr full = document::createFromString(html.c_str(), &container);
+  int width = full->render(800);
+  int height = full->height();
+
+  document::ptr doc = document::createFromString(html.c_str(), &container);
+  EXPECT_EQ(doc->render(800, position(0, 0, 800, 600)), width);
+  EXPECT_GT(doc->height(), 600);
+  auto body = doc->root_render_item()->children().back();
+  auto full_body = full->root_render_item()->children().back();
+  int deferred = count_deferred(body);
+  EXPECT_GT(deferred, 1000);
+
+  // the laid out blocks are placed exactly as by the full layout
+  Bitmap bmp(800, 600);
+  position clip(0, 0, 800, 600);
+  doc->draw((uint_ptr) &bmp, 0, -5000, &clip);
+  EXPECT_LT(count_deferred(body), deferred);
+  auto child = body->children().begin();
+  auto full_child = full_body->children().begin();
+  for (; child != body->children().end(); ++child, ++full_child)
+  {
+    if ((*child)->skip()) break;
+    EXPECT_EQ((*child)->get_placement().y, (*full_child)->get_placement().y);
+    EXPECT_EQ((*child)->get_placement().height, (*full_child)->get_placement().height);
+  }
+  EXPECT_GT((*full_child)->get_placement().y, 5600);
+
+  // hit-testing the end lays out the whole document
+  position::vector redraw_boxes;
+  doc->on_mouse_over(10, doc->height() - 1, 10, 599, redraw_boxes);
+  EXPECT_EQ(count_deferred(body), 0);
+  EXPECT_EQ(doc->height(), height);
+}
+
+TEST(LayoutTest, FloatGallery) {
+  // many floats in one formatting context are wrapped into rows
+  string html = "<div style='width: 800px'>";
+  for (int i = 0; i < 3000; i++) html += "<div style='float: left; width: 100px; height: 100px'></div>";
+  html += "</div>";
+
+  test_container container(800, 600, "");
+  document::ptr doc = document::createFromString(html.c_str(), &container);
+  doc->render(800);
+
+  int i = 0;
+  for (const auto& el : doc->root()->select_all("div[style^=float]"))
+  {
+    position pos = el->get_placement();
+    EXPECT_EQ(pos.x, 8 + i % 8 * 100);
+    EXPECT_EQ(pos.y, 8 + i / 8 * 100);
+    i++;
+  }
+  EXPECT_EQ(i, 3000);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "litehtml.h"
+#include "../containers/test/test_container.h"
+using namespace litehtml;
+
+static std::vector<string> split(const char* text) {
+  test_container container(800, 600, "");
+  std::vector<string> ret;
+  container.split_text(text,
+      [&ret](const char* str, size_t len) { ret.push_back("w:" + string(str, len)); },
+      [&ret](const char* str, size_t len) { ret.push_back("s:" + string(str, len)); });
+  return ret;
+}
+
+TEST(SplitTextTest, Ascii) {
+  EXPECT_TRUE(split("").empty());
+  EXPECT_EQ(split("word"), std::vector<string>({"w:word"}));
+  EXPECT_EQ(split("the quick  brown\tfox\n"),
+            std::vector<string>({"w:the", "s: ", "w:quick", "s:  ", "w:brown", "s:\t", "w:fox", "s:\n"}));
+  EXPECT_EQ(split("a \t\n\n  b"), std::vector<string>({"w:a", "s: \t", "s:\n", "s:\n", "s:  ", "w:b"}));
+  EXPECT_EQ(split(" averyveryverylongwordthatspansseveralblocks "),
+            std::vector<string>({"s: ", "w:averyveryverylongwordthatspansseveralblocks", "s: "}));
+}
+
+TEST(SplitTextTest, Utf8) {
+  // multibyte characters outside of the CJK range stay inside words
+  EXPECT_EQ(split("caf\xC3\xA9 na\xC3\xAFve"), std::vector<string>({"w:caf\xC3\xA9", "s: ", "w:na\xC3\xAFve"}));
+  // CJK ideographs are split into separate words
+  EXPECT_EQ(split("ab\xE4\xB8\xAD\xE6\x96\x87" "cd"),
+            std::vector<string>({"w:ab", "w:\xE4\xB8\xAD", "w:\xE6\x96\x87", "w:cd"}));
+  // truncated sequence
+  EXPECT_EQ(split("a\xE4\xB8"), std::vector<string>({"w:a\xE4\xB8"}));
+}
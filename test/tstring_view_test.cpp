@@ -75,3 +75,15 @@ TEST(TStringViewTest, RangeForLoop)
         std::cout << c << std::endl;
     }
 }
+
+TEST(TStringViewTest, Compare)
+{
+    string string = "the quick brown fox jumps over the lazy dog";
+    tstring_view view(string.data() + 4, 5);
+
+    EXPECT_TRUE(view == "quick");
+    EXPECT_TRUE(view != "quic");
+    EXPECT_TRUE(view != "brown");
+    EXPECT_TRUE(tstring_view() == "");
+    EXPECT_EQ(5u, tstring_view("quick").size());
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "litehtml.h"
+
+using namespace litehtml;
+
+TEST(WebColorTest, Hex) {
+  EXPECT_EQ(web_color::from_string("#f00", nullptr), web_color(255, 0, 0));
+  EXPECT_EQ(web_color::from_string("#F0F8FF", nullptr), web_color(0xF0, 0xF8, 0xFF));
+  EXPECT_EQ(web_color::from_string("#0f08", nullptr), web_color(0, 255, 0, 0x88));
+  EXPECT_EQ(web_color::from_string("#11223344", nullptr), web_color(0x11, 0x22, 0x33, 0x44));
+  EXPECT_EQ(web_color::from_string("#12345", nullptr), web_color(0, 0, 0));
+  EXPECT_EQ(web_color::from_string("#ggg", nullptr), web_color(0, 0, 0));
+}
+
+TEST(WebColorTest, Rgb) {
+  EXPECT_EQ(web_color::from_string("rgb(1, 2, 3)", nullptr), web_color(1, 2, 3));
+  EXPECT_EQ(web_color::from_string("rgba(1,2,3,0)", nullptr), web_color(1, 2, 3, 0));
+  EXPECT_EQ(web_color::from_string("rgb(100% 0% 50% / 50%)", nullptr), web_color(255, 0, 128, 127));
+  EXPECT_EQ(web_color::from_string("rgb(300, -5, 0)", nullptr), web_color(255, 0, 0));
+}
+
+TEST(WebColorTest, Hsl) {
+  EXPECT_EQ(web_color::from_string("hsl(0, 100%, 50%)", nullptr), web_color(255, 0, 0));
+  EXPECT_EQ(web_color::from_string("hsl(120deg 100% 25%)", nullptr), web_color(0, 128, 0));
+  EXPECT_EQ(web_color::from_string("hsla(240, 100%, 50%, 0)", nullptr), web_color(0, 0, 255, 0));
+  EXPECT_EQ(web_color::from_string("hsl(0, 0%, 100%)", nullptr), web_color(255, 255, 255));
+}
+
+TEST(WebColorTest, Names) {
+  EXPECT_EQ(web_color::from_string("red", nullptr), web_color(255, 0, 0));
+  EXPECT_EQ(web_color::from_string("AliceBlue", nullptr), web_color(0xF0, 0xF8, 0xFF));
+  EXPECT_EQ(web_color::from_string("transparent", nullptr), web_color::transparent);
+  EXPECT_EQ(web_color::resolve_name("DARKGREY", nullptr), "#A9A9A9");
+  EXPECT_TRUE(web_color::is_color("hsl(0,0%,0%)", nullptr));
+  EXPECT_TRUE(web_color::is_color("Navy", nullptr));
+  EXPECT_FALSE(web_color::is_color("nocolor", nullptr));
+  EXPECT_FALSE(web_color::is_color("", nullptr));
+}